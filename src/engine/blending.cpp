@@ -0,0 +1,152 @@
+#include "blending.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HAS_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(HAS_SSE2) && defined(__GNUC__)
+#define HAS_AVX2 1
+#include <immintrin.h>
+#endif
+
+void blendLinearLightScalar(uint32_t* pixels, int count, Color color)
+{
+    float dstR = color.r / 255.0f;
+    float dstG = color.g / 255.0f;
+    float dstB = color.b / 255.0f;
+
+    for (uint32_t* pixel = pixels; pixel != pixels + count; ++pixel)
+    {
+        float srcR = ((*pixel & 0xFF000000) >> 24) / 255.0f;
+        float srcG = ((*pixel & 0x00FF0000) >> 16) / 255.0f;
+        float srcB = ((*pixel & 0x0000FF00) >> 8) / 255.0f;
+
+        srcR = (dstR > 0.5f) * (srcR + 2.0f * (dstR - 0.5f)) + (dstR <= 0.5f) * (srcR + 2.0f * dstR - 1.0f);
+        srcG = (dstG > 0.5f) * (srcG + 2.0f * (dstG - 0.5f)) + (dstG <= 0.5f) * (srcG + 2.0f * dstG - 1.0f);
+        srcB = (dstB > 0.5f) * (srcB + 2.0f * (dstB - 0.5f)) + (dstB <= 0.5f) * (srcB + 2.0f * dstB - 1.0f);
+
+        srcR = srcR < 0.0f ? 0.0f : srcR > 1.0f ? 1.0f : srcR;
+        srcG = srcG < 0.0f ? 0.0f : srcG > 1.0f ? 1.0f : srcG;
+        srcB = srcB < 0.0f ? 0.0f : srcB > 1.0f ? 1.0f : srcB;
+
+        *pixel = uint32_t(255 * srcR) << 24 | uint32_t(255 * srcG) << 16 | uint32_t(255 * srcB) << 8 | 255;
+    }
+}
+
+#ifdef HAS_SSE2
+
+namespace
+{
+    /// The scalar formula computes `src + 2 * (dst - 0.5)` if dst > 0.5, and `src + 2 * dst - 1`
+    /// otherwise. Both are evaluated here as `(src + add) - subtract`, which performs the same
+    /// floating-point operations in the same order, so the vector kernels round identically.
+    struct LinearLightChannel
+    {
+        float add;
+        float subtract;
+
+        LinearLightChannel(uint8_t value)
+        {
+            float dst = value / 255.0f;
+
+            if (dst > 0.5f)
+            {
+                add = 2.0f * (dst - 0.5f);
+                subtract = 0.0f;
+            }
+            else
+            {
+                add = 2.0f * dst;
+                subtract = 1.0f;
+            }
+        }
+    };
+}
+
+static __m128 blendChannel(__m128i channel, LinearLightChannel constants)
+{
+    __m128 src = _mm_div_ps(_mm_cvtepi32_ps(channel), _mm_set1_ps(255.0f));
+    src = _mm_sub_ps(_mm_add_ps(src, _mm_set1_ps(constants.add)), _mm_set1_ps(constants.subtract));
+    src = _mm_min_ps(_mm_max_ps(src, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+    return _mm_mul_ps(src, _mm_set1_ps(255.0f));
+}
+
+static int blendLinearLightSSE2(uint32_t* pixels, int count, Color color)
+{
+    LinearLightChannel r(color.r), g(color.g), b(color.b);
+    const __m128i channelMask = _mm_set1_epi32(0xFF);
+    int index = 0;
+
+    for (; index + 4 <= count; index += 4)
+    {
+        auto* address = reinterpret_cast<__m128i*>(pixels + index);
+        __m128i pixel = _mm_loadu_si128(address);
+        __m128 srcR = blendChannel(_mm_srli_epi32(pixel, 24), r);
+        __m128 srcG = blendChannel(_mm_and_si128(_mm_srli_epi32(pixel, 16), channelMask), g);
+        __m128 srcB = blendChannel(_mm_and_si128(_mm_srli_epi32(pixel, 8), channelMask), b);
+
+        __m128i result = _mm_or_si128(_mm_slli_epi32(_mm_cvttps_epi32(srcR), 24), _mm_slli_epi32(_mm_cvttps_epi32(srcG), 16));
+        result = _mm_or_si128(result, _mm_slli_epi32(_mm_cvttps_epi32(srcB), 8));
+        _mm_storeu_si128(address, _mm_or_si128(result, channelMask));
+    }
+
+    return index;
+}
+
+#endif
+
+#ifdef HAS_AVX2
+
+__attribute__((target("avx2")))
+static __m256 blendChannelAVX2(__m256i channel, LinearLightChannel constants)
+{
+    __m256 src = _mm256_div_ps(_mm256_cvtepi32_ps(channel), _mm256_set1_ps(255.0f));
+    src = _mm256_sub_ps(_mm256_add_ps(src, _mm256_set1_ps(constants.add)), _mm256_set1_ps(constants.subtract));
+    src = _mm256_min_ps(_mm256_max_ps(src, _mm256_setzero_ps()), _mm256_set1_ps(1.0f));
+    return _mm256_mul_ps(src, _mm256_set1_ps(255.0f));
+}
+
+__attribute__((target("avx2")))
+static int blendLinearLightAVX2(uint32_t* pixels, int count, Color color)
+{
+    LinearLightChannel r(color.r), g(color.g), b(color.b);
+    const __m256i channelMask = _mm256_set1_epi32(0xFF);
+    int index = 0;
+
+    for (; index + 8 <= count; index += 8)
+    {
+        auto* address = reinterpret_cast<__m256i*>(pixels + index);
+        __m256i pixel = _mm256_loadu_si256(address);
+        __m256 srcR = blendChannelAVX2(_mm256_srli_epi32(pixel, 24), r);
+        __m256 srcG = blendChannelAVX2(_mm256_and_si256(_mm256_srli_epi32(pixel, 16), channelMask), g);
+        __m256 srcB = blendChannelAVX2(_mm256_and_si256(_mm256_srli_epi32(pixel, 8), channelMask), b);
+
+        __m256i result = _mm256_or_si256(_mm256_slli_epi32(_mm256_cvttps_epi32(srcR), 24),
+                                         _mm256_slli_epi32(_mm256_cvttps_epi32(srcG), 16));
+        result = _mm256_or_si256(result, _mm256_slli_epi32(_mm256_cvttps_epi32(srcB), 8));
+        _mm256_storeu_si256(address, _mm256_or_si256(result, channelMask));
+    }
+
+    return index;
+}
+
+#endif
+
+void blendLinearLight(uint32_t* pixels, int count, Color color)
+{
+    int index = 0;
+
+#ifdef HAS_AVX2
+    static const bool hasAVX2 = __builtin_cpu_supports("avx2");
+
+    if (hasAVX2)
+        index = blendLinearLightAVX2(pixels, count, color);
+#endif
+
+#ifdef HAS_SSE2
+    index += blendLinearLightSSE2(pixels + index, count - index, color);
+#endif
+
+    blendLinearLightScalar(pixels + index, count - index, color);
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "color.h"
+#include <cstdint>
+
+/// Blends `count` RGBA8888 pixels with `color` using the LinearLight blend mode. Processes several
+/// pixels at once using the widest vector instructions supported by the CPU. The result is always
+/// identical to that of blendLinearLightScalar.
+void blendLinearLight(uint32_t* pixels, int count, Color color);
+/// Reference implementation of blendLinearLight that processes one pixel at a time.
+void blendLinearLightScalar(uint32_t* pixels, int count, Color color);
@@ -1,8 +1,14 @@
 #include "config.h"
 #include "assert.h"
+#include "filesystem.h"
 #include "utility.h"
+#include <algorithm>
 #include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
+#include <mutex>
 #include <stdexcept>
 
 /// Wrapper around std::ifstream that keeps track of the current line and column.
@@ -152,17 +158,179 @@ std::runtime_error ConfigReader::syntaxError(std::string_view expected, char act
     return syntaxError("expected " + expected + ", got " + charToString(actual));
 }
 
+namespace
+{
+    /// The compiled form of a config consists of this header followed by the type ids, the attribute
+    /// names, the attribute table, the values, and the string table. The attribute table has a row for
+    /// each type and a column for each attribute, with the attributes inherited from base types
+    /// already resolved.
+    struct CompiledHeader
+    {
+        char magic[4];
+        uint32_t version;
+        /// Modification time and size of the config file the compiled form was created from.
+        int64_t sourceModificationTime;
+        int64_t sourceSize;
+        uint32_t typeCount;
+        uint32_t attributeCount;
+        uint32_t valueCount;
+        uint32_t stringTableSize;
+    };
+
+    const char compiledMagic[4] = { 'Z', 'C', 'F', 'G' };
+    const uint32_t compiledVersion = 2;
+    const uint32_t missingIndex = UINT32_MAX;
+
+    struct CompiledString
+    {
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    struct CompiledAttribute
+    {
+        /// Index of the value, or `missingIndex` if the type doesn't have the attribute.
+        uint32_t value;
+        /// Index of the type that defines the value, either the type itself or one of its base types.
+        uint32_t definingType;
+    };
+
+    enum class CompiledValueType : uint32_t
+    {
+        Bool,
+        Int,
+        Float,
+        String,
+        List
+    };
+
+    struct CompiledValueRecord
+    {
+        CompiledValueType type;
+        /// Length of a string, or number of elements in a list.
+        uint32_t size;
+
+        union
+        {
+            int64_t integer;
+            double floatingPoint;
+            /// Offset of a string in the string table, or index of the first element of a list. The
+            /// elements of a list are stored contiguously.
+            uint64_t offset;
+        };
+    };
+
+    struct CompiledLayout
+    {
+        const CompiledHeader* header;
+        const CompiledString* typeIds;
+        const CompiledString* attributeNames;
+        const CompiledAttribute* attributes;
+        const CompiledValueRecord* values;
+        const char* strings;
+
+        CompiledLayout(const char* data)
+        {
+            header = reinterpret_cast<const CompiledHeader*>(data);
+            typeIds = reinterpret_cast<const CompiledString*>(header + 1);
+            attributeNames = typeIds + header->typeCount;
+            attributes = reinterpret_cast<const CompiledAttribute*>(attributeNames + header->attributeCount);
+            values = reinterpret_cast<const CompiledValueRecord*>(attributes + size_t(header->typeCount) * header->attributeCount);
+            strings = reinterpret_cast<const char*>(values + header->valueCount);
+        }
+
+        const CompiledAttribute& getAttribute(uint32_t type, uint32_t column) const
+        {
+            return attributes[size_t(type) * header->attributeCount + column];
+        }
+
+        std::string_view getString(CompiledString string) const
+        {
+            return std::string_view(strings + string.offset, string.length);
+        }
+
+        static size_t getSize(const CompiledHeader& header)
+        {
+            return sizeof(CompiledHeader) + (size_t(header.typeCount) + header.attributeCount) * sizeof(CompiledString)
+                + size_t(header.typeCount) * header.attributeCount * sizeof(CompiledAttribute)
+                + size_t(header.valueCount) * sizeof(CompiledValueRecord) + header.stringTableSize;
+        }
+    };
+
+    /// A view of a value in the compiled form of a config, with the same interface as Config::Value.
+    class CompiledValue
+    {
+    public:
+        class List
+        {
+        public:
+            class Iterator
+            {
+            public:
+                Iterator(const CompiledLayout& layout, uint64_t index) : layout(layout), index(index) {}
+                CompiledValue operator*() const { return CompiledValue(layout, index); }
+                Iterator& operator++() { ++index; return *this; }
+                bool operator!=(const Iterator& other) const { return index != other.index; }
+
+            private:
+                const CompiledLayout& layout;
+                uint64_t index;
+            };
+
+            List(const CompiledLayout& layout, const CompiledValueRecord& record) : layout(layout), record(record) {}
+            Iterator begin() const { return Iterator(layout, record.offset); }
+            Iterator end() const { return Iterator(layout, record.offset + record.size); }
+
+        private:
+            const CompiledLayout& layout;
+            const CompiledValueRecord& record;
+        };
+
+        CompiledValue(const CompiledLayout& layout, uint64_t index) : layout(layout), record(layout.values[index]) {}
+        bool isBool() const { return record.type == CompiledValueType::Bool; }
+        bool isInt() const { return record.type == CompiledValueType::Int; }
+        bool isFloat() const { return record.type == CompiledValueType::Float; }
+        bool isString() const { return record.type == CompiledValueType::String; }
+        bool isList() const { return record.type == CompiledValueType::List; }
+        bool getBool() const { return record.integer != 0; }
+        long long getInt() const { return record.integer; }
+        double getFloat() const { return record.floatingPoint; }
+        std::string_view getString() const { return layout.getString({ uint32_t(record.offset), record.size }); }
+        List getList() const { return List(layout, record); }
+
+    private:
+        const CompiledLayout& layout;
+        const CompiledValueRecord& record;
+    };
+}
+
 std::vector<std::string> Config::getToplevelKeys() const
 {
     std::vector<std::string> keys;
 
-    for (auto& keyAndValue : data)
+    if (!compiledData)
+        return keys;
+
+    CompiledLayout layout(compiledData);
+    auto isAbstract = attributeHandles.find("isAbstract");
+
+    for (uint32_t type = 0; type < uint32_t(typeCount); ++type)
     {
-        if (auto it = keyAndValue.second.getGroup().getOptional("isAbstract"))
-            if (it->isBool() && it->getBool())
-                continue;
+        // isAbstract is not inherited, so only consider the value defined by the type itself.
+        if (isAbstract != attributeHandles.end())
+        {
+            auto& attribute = layout.getAttribute(type, uint32_t(attributeColumns[isAbstract->second]));
+
+            if (attribute.value != missingIndex && attribute.definingType == type)
+            {
+                CompiledValue value(layout, attribute.value);
+
+                if (value.isBool() && value.getBool())
+                    continue;
+            }
+        }
 
-        keys.push_back(keyAndValue.first);
+        keys.emplace_back(layout.getString(layout.typeIds[type]));
     }
 
     return keys;
@@ -305,6 +473,50 @@ Config::Value Config::parseAtomicValue(ConfigReader& reader)
 }
 
 Config::Config(std::string_view filePath)
+{
+    parseFile(filePath);
+    compile();
+}
+
+Config::Config(std::string_view filePath, std::string_view cachePath)
+{
+    std::string sourcePath(filePath);
+    std::string compiledPath(cachePath);
+    auto sourceModificationTime = fs::getModificationTime(sourcePath.c_str());
+    auto sourceSize = fs::getSize(sourcePath.c_str());
+
+    if (fs::exists(compiledPath.c_str()))
+    {
+        auto mapping = std::make_unique<MemoryMapping>(compiledPath);
+        auto* header = reinterpret_cast<const CompiledHeader*>(mapping->getData());
+
+        if (mapping->getSize() >= sizeof(CompiledHeader) && header->sourceModificationTime == sourceModificationTime
+            && header->sourceSize == sourceSize && loadCompiled(mapping->getData(), mapping->getSize()))
+        {
+            compiledMapping = std::move(mapping);
+            return;
+        }
+    }
+
+    parseFile(filePath);
+    compile();
+
+    auto* header = reinterpret_cast<CompiledHeader*>(compiledStorage.data());
+    header->sourceModificationTime = sourceModificationTime;
+    header->sourceSize = sourceSize;
+
+    // Write to a temporary file first so that a partially written cache is never loaded. Failing to
+    // write the cache is not an error, the config is just parsed again the next time.
+    auto temporaryPath = compiledPath + ".tmp";
+    std::ofstream file(temporaryPath, std::ios::binary);
+    file.write(compiledStorage.data(), std::streamsize(compiledStorage.size()));
+    file.close();
+
+    if (!file || !fs::replace(temporaryPath.c_str(), compiledPath.c_str()))
+        std::remove(temporaryPath.c_str());
+}
+
+void Config::parseFile(std::string_view filePath)
 {
     ConfigReader reader(filePath);
 
@@ -340,6 +552,324 @@ Config::Config(std::string_view filePath)
     }
 }
 
+void Config::compile()
+{
+    struct Builder
+    {
+        std::string strings;
+        std::unordered_map<std::string_view, CompiledString> stringIndices;
+        std::vector<CompiledValueRecord> values;
+        std::unordered_map<const Value*, uint32_t> valueIndices;
+
+        CompiledString addString(std::string_view string)
+        {
+            auto it = stringIndices.find(string);
+
+            if (it != stringIndices.end())
+                return it->second;
+
+            CompiledString compiledString = { uint32_t(strings.size()), uint32_t(string.size()) };
+            strings += string;
+            stringIndices.emplace(string, compiledString);
+            return compiledString;
+        }
+
+        uint32_t addValue(const Value& value)
+        {
+            auto it = valueIndices.find(&value);
+
+            if (it != valueIndices.end())
+                return it->second;
+
+            auto index = uint32_t(values.size());
+            values.emplace_back();
+            setValue(index, value);
+            valueIndices.emplace(&value, index);
+            return index;
+        }
+
+        void setValue(size_t index, const Value& value)
+        {
+            CompiledValueRecord record = {};
+
+            switch (value.getType())
+            {
+                case Value::Type::Bool:
+                    record.type = CompiledValueType::Bool;
+                    record.integer = value.getBool();
+                    break;
+                case Value::Type::Int:
+                    record.type = CompiledValueType::Int;
+                    record.integer = value.getInt();
+                    break;
+                case Value::Type::Float:
+                    record.type = CompiledValueType::Float;
+                    record.floatingPoint = value.getFloat();
+                    break;
+                case Value::Type::String:
+                {
+                    auto string = addString(value.getString());
+                    record.type = CompiledValueType::String;
+                    record.size = string.length;
+                    record.offset = string.offset;
+                    break;
+                }
+                case Value::Type::List:
+                {
+                    auto& list = value.getList();
+                    record.type = CompiledValueType::List;
+                    record.size = uint32_t(list.size());
+                    record.offset = values.size();
+                    values.resize(values.size() + list.size());
+
+                    for (size_t i = 0; i < list.size(); ++i)
+                        setValue(size_t(record.offset) + i, list[i]);
+
+                    break;
+                }
+                case Value::Type::Group:
+                    ASSERT(false && "nested groups are not supported");
+                    break;
+            }
+
+            values[index] = record;
+        }
+    };
+
+    std::vector<std::string_view> typeIds;
+    std::unordered_map<std::string_view, uint32_t> typeIndices;
+    std::vector<std::string_view> attributeNames;
+    std::unordered_map<std::string_view, uint32_t> attributeIndices;
+
+    for (auto& [id, value] : data)
+    {
+        if (!value.isGroup())
+            continue;
+
+        typeIndices.emplace(id, uint32_t(typeIds.size()));
+        typeIds.push_back(id);
+
+        for (auto& attributeAndValue : value.getGroup())
+        {
+            if (attributeIndices.emplace(attributeAndValue.first, uint32_t(attributeNames.size())).second)
+                attributeNames.push_back(attributeAndValue.first);
+        }
+    }
+
+    Builder builder;
+    std::vector<CompiledAttribute> attributes(typeIds.size() * attributeNames.size(), { missingIndex, missingIndex });
+
+    for (size_t type = 0; type < typeIds.size(); ++type)
+    {
+        auto* row = &attributes[type * attributeNames.size()];
+        std::string_view current = typeIds[type];
+
+        // Attributes defined by a type override the ones inherited from its base types.
+        for (size_t depth = 0;; ++depth)
+        {
+            if (depth > typeIds.size())
+                throw std::runtime_error("BaseType of \"" + std::string(typeIds[type]) + "\" is cyclic!");
+
+            auto& group = data.getOptional(std::string(current))->getGroup();
+
+            for (auto& [attribute, value] : group)
+            {
+                auto& compiledAttribute = row[attributeIndices.at(attribute)];
+
+                if (compiledAttribute.value == missingIndex)
+                    compiledAttribute = { builder.addValue(value), typeIndices.at(current) };
+            }
+
+            auto baseType = group.getOptional("BaseType");
+
+            if (!baseType)
+                break;
+
+            if (!baseType->isString())
+                throw std::runtime_error("BaseType of \"" + std::string(current) + "\" has wrong type!");
+
+            auto baseTypeIndex = typeIndices.find(baseType->getString());
+
+            if (baseTypeIndex == typeIndices.end())
+                throw std::runtime_error("BaseType \"" + baseType->getString() + "\" doesn't exist!");
+
+            current = baseTypeIndex->first;
+        }
+    }
+
+    std::vector<CompiledString> strings;
+
+    for (auto id : typeIds)
+        strings.push_back(builder.addString(id));
+
+    for (auto attributeName : attributeNames)
+        strings.push_back(builder.addString(attributeName));
+
+    CompiledHeader header = {};
+    std::memcpy(header.magic, compiledMagic, sizeof(compiledMagic));
+    header.version = compiledVersion;
+    header.typeCount = uint32_t(typeIds.size());
+    header.attributeCount = uint32_t(attributeNames.size());
+    header.valueCount = uint32_t(builder.values.size());
+    header.stringTableSize = uint32_t(builder.strings.size());
+
+    auto append = [&](const void* source, size_t size)
+    {
+        auto* bytes = static_cast<const char*>(source);
+        compiledStorage.insert(compiledStorage.end(), bytes, bytes + size);
+    };
+
+    compiledStorage.clear();
+    compiledStorage.reserve(CompiledLayout::getSize(header));
+    append(&header, sizeof(header));
+    append(strings.data(), strings.size() * sizeof(CompiledString));
+    append(attributes.data(), attributes.size() * sizeof(CompiledAttribute));
+    append(builder.values.data(), builder.values.size() * sizeof(CompiledValueRecord));
+    append(builder.strings.data(), builder.strings.size());
+
+    bool isLoaded = loadCompiled(compiledStorage.data(), compiledStorage.size());
+    ASSERT(isLoaded);
+    (void) isLoaded;
+}
+
+bool Config::loadCompiled(const char* compiledData, size_t size)
+{
+    if (size < sizeof(CompiledHeader))
+        return false;
+
+    CompiledLayout layout(compiledData);
+
+    // Check the attribute table on its own first, as its size could overflow when added up with the rest.
+    if (std::memcmp(layout.header->magic, compiledMagic, sizeof(compiledMagic)) != 0
+        || layout.header->version != compiledVersion
+        || uint64_t(layout.header->typeCount) * layout.header->attributeCount > size / sizeof(CompiledAttribute)
+        || size != CompiledLayout::getSize(*layout.header))
+        return false;
+
+    // A cache file could be corrupted, so check that every string, value and type it refers to is
+    // within bounds, and that each list's elements come after it so that nested lists terminate.
+    auto& header = *layout.header;
+
+    auto isInBounds = [](uint64_t offset, uint64_t count, uint64_t size)
+    {
+        return count <= size && offset <= size - count;
+    };
+
+    // The type ids are directly followed by the attribute names.
+    for (size_t i = 0; i < size_t(header.typeCount) + header.attributeCount; ++i)
+    {
+        if (!isInBounds(layout.typeIds[i].offset, layout.typeIds[i].length, header.stringTableSize))
+            return false;
+    }
+
+    for (size_t i = 0; i < size_t(header.typeCount) * header.attributeCount; ++i)
+    {
+        auto& attribute = layout.attributes[i];
+
+        if (attribute.value == missingIndex)
+        {
+            if (attribute.definingType != missingIndex)
+                return false;
+        }
+        else if (attribute.value >= header.valueCount || attribute.definingType >= header.typeCount)
+            return false;
+    }
+
+    for (uint32_t i = 0; i < header.valueCount; ++i)
+    {
+        auto& record = layout.values[i];
+
+        switch (record.type)
+        {
+            case CompiledValueType::Bool:
+            case CompiledValueType::Int:
+            case CompiledValueType::Float:
+                break;
+            case CompiledValueType::String:
+                if (!isInBounds(record.offset, record.size, header.stringTableSize))
+                    return false;
+                break;
+            case CompiledValueType::List:
+                if (record.offset <= i || !isInBounds(record.offset, record.size, header.valueCount))
+                    return false;
+                break;
+            default:
+                return false;
+        }
+    }
+
+    this->compiledData = compiledData;
+    typeCount = int(layout.header->typeCount);
+    typeHandles.clear();
+    attributeHandles.clear();
+    attributeColumns.clear();
+
+    for (uint32_t type = 0; type < layout.header->typeCount; ++type)
+        typeHandles.emplace(layout.getString(layout.typeIds[type]), TypeHandle(type));
+
+    for (uint32_t column = 0; column < layout.header->attributeCount; ++column)
+    {
+        auto attributeName = layout.getString(layout.attributeNames[column]);
+        auto handle = getAttributeHandle(attributeName);
+        attributeHandles.emplace(attributeName, handle);
+
+        if (attributeColumns.size() <= size_t(handle))
+            attributeColumns.resize(size_t(handle) + 1, -1);
+
+        attributeColumns[handle] = int(column);
+    }
+
+    return true;
+}
+
+namespace
+{
+    struct AttributeNames
+    {
+        std::mutex mutex;
+        std::unordered_map<std::string, Config::AttributeHandle> handles;
+        std::vector<std::string> names;
+    };
+}
+
+static AttributeNames& getAttributeNames()
+{
+    static AttributeNames attributeNames;
+    return attributeNames;
+}
+
+Config::AttributeHandle Config::getAttributeHandle(std::string_view attribute)
+{
+    auto& attributeNames = getAttributeNames();
+    std::lock_guard<std::mutex> lock(attributeNames.mutex);
+    auto handle = attributeNames.handles.emplace(std::string(attribute), AttributeHandle(attributeNames.names.size()));
+
+    if (handle.second)
+        attributeNames.names.emplace_back(attribute);
+
+    return handle.first->second;
+}
+
+std::string Config::getAttributeName(AttributeHandle attribute)
+{
+    auto& attributeNames = getAttributeNames();
+    std::lock_guard<std::mutex> lock(attributeNames.mutex);
+    return attributeNames.names.at(size_t(attribute));
+}
+
+Config::TypeHandle Config::getTypeHandle(std::string_view type) const
+{
+    auto it = typeHandles.find(type);
+    return it != typeHandles.end() ? it->second : invalidHandle;
+}
+
+std::string_view Config::getTypeId(TypeHandle type) const
+{
+    ASSERT(type >= 0 && type < typeCount);
+    CompiledLayout layout(compiledData);
+    return layout.getString(layout.typeIds[type]);
+}
+
 void Config::printValue(std::ostream& stream, const Config::Value& value) const
 {
     switch (value.getType())
@@ -456,8 +986,8 @@ void Config::Group::insert(std::string&& key, Config::Value&& value)
     properties.emplace(std::move(key), std::move(value));
 }
 
-template<typename OutputType>
-std::optional<OutputType> Config::convert(const Value& value)
+template<typename OutputType, typename InputType>
+std::optional<OutputType> Config::convert(const InputType& value)
 {
     return Converter<OutputType>()(value);
 }
@@ -465,13 +995,15 @@ std::optional<OutputType> Config::convert(const Value& value)
 template<typename OutputType>
 struct Config::Converter
 {
-    std::optional<OutputType> operator()(const Value& value);
+    template<typename InputType>
+    std::optional<OutputType> operator()(const InputType& value);
 };
 
 template<>
 struct Config::Converter<bool>
 {
-    std::optional<bool> operator()(const Value& value)
+    template<typename InputType>
+    std::optional<bool> operator()(const InputType& value)
     {
         if (value.isBool())
             return value.getBool();
@@ -483,7 +1015,8 @@ struct Config::Converter<bool>
 template<>
 struct Config::Converter<int>
 {
-    std::optional<int> operator()(const Value& value)
+    template<typename InputType>
+    std::optional<int> operator()(const InputType& value)
     {
         if (value.isInt())
             return static_cast<int>(value.getInt());
@@ -495,7 +1028,8 @@ struct Config::Converter<int>
 template<>
 struct Config::Converter<unsigned>
 {
-    std::optional<unsigned> operator()(const Value& value)
+    template<typename InputType>
+    std::optional<unsigned> operator()(const InputType& value)
     {
         if (value.isInt())
             return static_cast<unsigned>(value.getInt());
@@ -507,7 +1041,8 @@ struct Config::Converter<unsigned>
 template<>
 struct Config::Converter<unsigned short>
 {
-    std::optional<unsigned short> operator()(const Value& value)
+    template<typename InputType>
+    std::optional<unsigned short> operator()(const InputType& value)
     {
         if (value.isInt())
             return static_cast<unsigned short>(value.getInt());
@@ -519,7 +1054,8 @@ struct Config::Converter<unsigned short>
 template<>
 struct Config::Converter<double>
 {
-    std::optional<double> operator()(const Value& value)
+    template<typename InputType>
+    std::optional<double> operator()(const InputType& value)
     {
         if (value.isFloat())
             return value.getFloat();
@@ -534,10 +1070,11 @@ struct Config::Converter<double>
 template<>
 struct Config::Converter<std::string>
 {
-    std::optional<std::string> operator()(const Value& value)
+    template<typename InputType>
+    std::optional<std::string> operator()(const InputType& value)
     {
         if (value.isString())
-            return value.getString();
+            return std::string(value.getString());
 
         return std::nullopt;
     }
@@ -546,14 +1083,15 @@ struct Config::Converter<std::string>
 template<typename ElementType>
 struct Config::Converter<std::vector<ElementType>>
 {
-    std::optional<std::vector<ElementType>> operator()(const Value& value)
+    template<typename InputType>
+    std::optional<std::vector<ElementType>> operator()(const InputType& value)
     {
         if (!value.isList())
             return std::nullopt;
 
         std::vector<ElementType> outputData;
 
-        for (auto& element : value.getList())
+        for (auto&& element : value.getList())
             outputData.push_back(*convert<ElementType>(element));
 
         return outputData;
@@ -581,43 +1119,41 @@ ValueType Config::get(std::string_view type, std::string_view attribute) const
 template<typename ValueType>
 std::optional<ValueType> Config::getOptional(std::string_view type, std::string_view attribute) const
 {
-    std::string current(type);
-    std::string key(attribute);
+    auto attributeHandle = attributeHandles.find(attribute);
 
-    while (true)
-    {
-        auto groupValue = data.getOptional(current);
-
-        if (!groupValue)
-            return std::nullopt;
+    if (attributeHandle == attributeHandles.end())
+        return std::nullopt;
 
-        auto& group = groupValue->getGroup();
+    return getOptional<ValueType>(getTypeHandle(type), attributeHandle->second);
+}
 
-        if (auto value = group.getOptional(key))
-        {
-            if (auto converted = convert<ValueType>(*value))
-                return *converted;
-            else
-                throw std::runtime_error("attribute \"" + attribute + "\" of class \"" + current + "\" has wrong type!");
-        }
+template<typename ValueType>
+ValueType Config::get(TypeHandle type, AttributeHandle attribute) const
+{
+    if (auto value = getOptional<ValueType>(type, attribute))
+        return ValueType(std::move(*value));
+    else
+        throw std::runtime_error("attribute \"" + getAttributeName(attribute) + "\" not found for \""
+                                 + (type != invalidHandle ? std::string(getTypeId(type)) : "") + "\"!");
+}
 
-        auto baseType = group.getOptional("BaseType");
+template<typename ValueType>
+std::optional<ValueType> Config::getOptional(TypeHandle type, AttributeHandle attribute) const
+{
+    if (type == invalidHandle || size_t(attribute) >= attributeColumns.size() || attributeColumns[attribute] == -1)
+        return std::nullopt;
 
-        if (!baseType)
-            return std::nullopt;
+    CompiledLayout layout(compiledData);
+    auto& compiledAttribute = layout.getAttribute(uint32_t(type), uint32_t(attributeColumns[attribute]));
 
-        if (baseType->isString())
-        {
-            auto& baseTypeString = baseType->getString();
+    if (compiledAttribute.value == missingIndex)
+        return std::nullopt;
 
-            if (data.getOptional(baseTypeString) == nullptr)
-                throw std::runtime_error("BaseType \"" + baseTypeString + "\" doesn't exist!");
+    if (auto converted = convert<ValueType>(CompiledValue(layout, compiledAttribute.value)))
+        return converted;
 
-            current = baseTypeString;
-        }
-        else
-            throw std::runtime_error("BaseType of \"" + current + "\" has wrong type!");
-    }
+    throw std::runtime_error("attribute \"" + getAttributeName(attribute) + "\" of class \""
+                             + std::string(getTypeId(TypeHandle(compiledAttribute.definingType))) + "\" has wrong type!");
 }
 
 template bool Config::get(std::string_view, std::string_view) const;
@@ -627,6 +1163,9 @@ template std::string Config::get(std::string_view, std::string_view) const;
 template std::vector<int> Config::get(std::string_view, std::string_view) const;
 template std::vector<std::string> Config::get(std::string_view, std::string_view) const;
 template std::vector<std::vector<int>> Config::get(std::string_view, std::string_view) const;
+template bool Config::get(TypeHandle, AttributeHandle) const;
+template int Config::get(TypeHandle, AttributeHandle) const;
+template unsigned Config::get(TypeHandle, AttributeHandle) const;
 template std::optional<bool> Config::getOptional(std::string_view) const;
 template std::optional<int> Config::getOptional(std::string_view) const;
 template std::optional<double> Config::getOptional(std::string_view) const;
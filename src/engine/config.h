@@ -1,5 +1,6 @@
 #pragma once
 
+#include "memorymapping.h"
 #include <optional>
 #include <unordered_map>
 #include <iosfwd>
@@ -14,14 +15,37 @@ class ConfigReader;
 class Config
 {
 public:
+    /// Index of a type in the config. Lookups by handle don't hash any strings or walk the
+    /// BaseType chain, as the inherited attributes of each type are resolved when the config is loaded.
+    using TypeHandle = int;
+    /// Attribute names are interned globally, so an attribute handle can be obtained once and used
+    /// with any config.
+    using AttributeHandle = int;
+    static const int invalidHandle = -1;
+
     Config() {}
     Config(std::string_view filePath);
+    /// Loads the compiled form of the config file at `filePath` from `cachePath` if the file hasn't
+    /// changed since it was compiled. Otherwise parses the config file and writes its compiled form
+    /// to `cachePath`. The compiled form contains only the types, with their inheritance resolved.
+    Config(std::string_view filePath, std::string_view cachePath);
+    Config(const Config&) = delete;
+    Config& operator=(const Config&) = delete;
     template<typename ValueType>
     std::optional<ValueType> getOptional(std::string_view key) const;
     template<typename ValueType>
     ValueType get(std::string_view type, std::string_view attribute) const;
     template<typename ValueType>
     std::optional<ValueType> getOptional(std::string_view type, std::string_view attribute) const;
+    template<typename ValueType>
+    ValueType get(TypeHandle type, AttributeHandle attribute) const;
+    template<typename ValueType>
+    std::optional<ValueType> getOptional(TypeHandle type, AttributeHandle attribute) const;
+    /// Returns `invalidHandle` if the config has no such type.
+    TypeHandle getTypeHandle(std::string_view type) const;
+    std::string_view getTypeId(TypeHandle type) const;
+    int getTypeCount() const { return typeCount; }
+    static AttributeHandle getAttributeHandle(std::string_view attribute);
     std::vector<std::string> getToplevelKeys() const;
     void set(std::string key, bool value) { data.insert(std::move(key), Value(value)); }
     void set(std::string key, long long value) { data.insert(std::move(key), Value(value)); }
@@ -98,8 +122,8 @@ private:
 
     template<typename OutputType>
     struct Converter;
-    template<typename OutputType>
-    static std::optional<OutputType> convert(const Value& value);
+    template<typename OutputType, typename InputType>
+    static std::optional<OutputType> convert(const InputType& value);
 
     Group parseGroup(ConfigReader& reader);
     Value parseProperty(ConfigReader& reader);
@@ -108,6 +132,24 @@ private:
     Value parseAtomicValue(ConfigReader& reader);
     Value parseNumber(ConfigReader& reader);
     void printValue(std::ostream& stream, const Config::Value& value) const;
+    void parseFile(std::string_view filePath);
+    void compile();
+    bool loadCompiled(const char* compiledData, size_t size);
+    static std::string getAttributeName(AttributeHandle attribute);
 
+    /// Top-level values and the types as they appear in the config file. Empty if the config was
+    /// loaded from its compiled form.
     Group data;
+    /// The compiled form of the config, which all type lookups read from. Points either into
+    /// `compiledStorage` or into `compiledMapping`.
+    const char* compiledData = nullptr;
+    std::vector<char> compiledStorage;
+    std::unique_ptr<MemoryMapping> compiledMapping;
+    int typeCount = 0;
+    std::unordered_map<std::string_view, TypeHandle> typeHandles;
+    /// Handles of the attribute names that appear in this config.
+    std::unordered_map<std::string_view, AttributeHandle> attributeHandles;
+    /// Column of each attribute handle in the compiled attribute table, or -1 if no type in this
+    /// config has the attribute. Indexed by attribute handle.
+    std::vector<int> attributeColumns;
 };
@@ -1,8 +1,58 @@
 #include "filesystem.h"
+#include <cstdio>
 #include <fstream>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#endif
 
 bool fs::exists(const char* path)
 {
     std::ifstream file(path);
     return file.good();
 }
+
+long long fs::getModificationTime(const char* path)
+{
+#ifdef _WIN32
+    WIN32_FILE_ATTRIBUTE_DATA attributes;
+
+    if (!GetFileAttributesExA(path, GetFileExInfoStandard, &attributes))
+        return -1;
+
+    // FILETIME counts 100-nanosecond intervals since 1601.
+    auto time = static_cast<long long>(attributes.ftLastWriteTime.dwHighDateTime) << 32 | attributes.ftLastWriteTime.dwLowDateTime;
+    return (time - 116444736000000000LL) * 100;
+#else
+    struct stat fileStatus;
+
+    if (stat(path, &fileStatus) != 0)
+        return -1;
+
+#ifdef __APPLE__
+    auto& time = fileStatus.st_mtimespec;
+#else
+    auto& time = fileStatus.st_mtim;
+#endif
+
+    return static_cast<long long>(time.tv_sec) * 1000000000LL + time.tv_nsec;
+#endif
+}
+
+long long fs::getSize(const char* path)
+{
+    struct stat fileStatus;
+    return stat(path, &fileStatus) == 0 ? static_cast<long long>(fileStatus.st_size) : -1;
+}
+
+bool fs::replace(const char* source, const char* target)
+{
+#ifdef _WIN32
+    return MoveFileExA(source, target, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return std::rename(source, target) == 0;
+#endif
+}
@@ -3,4 +3,12 @@
 namespace fs
 {
     bool exists(const char* path);
+    /// Returns the time of the last modification of the file in nanoseconds since the epoch, or -1
+    /// if the file doesn't exist. The actual resolution depends on the file system.
+    long long getModificationTime(const char* path);
+    /// Returns the size of the file in bytes, or -1 if the file doesn't exist.
+    long long getSize(const char* path);
+    /// Renames `source` to `target`, replacing `target` if it exists. On the same file system the
+    /// replacement is atomic, so `target` is never left partially written. Returns false on failure.
+    bool replace(const char* source, const char* target);
 }
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "geometry.h"
+
+namespace detail
+{
+    template<typename IsBlocking, typename SetVisible>
+    void castShadows(Vector2 origin, int radius, int row, double startSlope, double endSlope,
+                     Vector2 xTransform, Vector2 yTransform, IsBlocking& isBlocking, SetVisible& setVisible)
+    {
+        if (startSlope < endSlope)
+            return;
+
+        double nextStartSlope = startSlope;
+
+        for (int distance = row; distance <= radius; ++distance)
+        {
+            bool blocked = false;
+            int dy = -distance;
+
+            for (int dx = -distance; dx <= 0; ++dx)
+            {
+                double leftSlope = (dx - 0.5) / (dy + 0.5);
+                double rightSlope = (dx + 0.5) / (dy - 0.5);
+
+                if (startSlope < rightSlope)
+                    continue;
+
+                if (endSlope > leftSlope)
+                    break;
+
+                Vector2 position(origin.x + dx * xTransform.x + dy * xTransform.y,
+                                 origin.y + dx * yTransform.x + dy * yTransform.y);
+
+                if (dx * dx + dy * dy <= radius * radius)
+                    setVisible(position);
+
+                if (blocked)
+                {
+                    if (isBlocking(position))
+                    {
+                        nextStartSlope = rightSlope;
+                        continue;
+                    }
+
+                    blocked = false;
+                    startSlope = nextStartSlope;
+                }
+                else if (isBlocking(position) && distance < radius)
+                {
+                    blocked = true;
+                    castShadows(origin, radius, distance + 1, startSlope, leftSlope,
+                                xTransform, yTransform, isBlocking, setVisible);
+                    nextStartSlope = rightSlope;
+                }
+            }
+
+            if (blocked)
+                break;
+        }
+    }
+}
+
+/// Computes the points visible from `origin` within `radius` using recursive shadowcasting. Calls
+/// `setVisible` with each point that is within the radius and not obscured by a point for which
+/// `isBlocking` returns true. A blocking point is itself visible. Each point may be reported more
+/// than once. Runs in time proportional to the number of points in the radius.
+template<typename IsBlocking, typename SetVisible>
+void computeFieldOfVision(Vector2 origin, int radius, IsBlocking isBlocking, SetVisible setVisible)
+{
+    static const Vector2 octantTransforms[8][2] =
+    {
+        { { 1, 0 }, { 0, 1 } }, { { 0, 1 }, { 1, 0 } }, { { 0, -1 }, { 1, 0 } }, { { -1, 0 }, { 0, 1 } },
+        { { -1, 0 }, { 0, -1 } }, { { 0, -1 }, { -1, 0 } }, { { 0, 1 }, { -1, 0 } }, { { 1, 0 }, { 0, -1 } }
+    };
+
+    setVisible(origin);
+
+    for (auto& transform : octantTransforms)
+        detail::castShadows(origin, radius, 1, 1.0, 0.0, transform[0], transform[1], isBlocking, setVisible);
+}
@@ -1,11 +1,13 @@
 #include "graphics.h"
 #include "assert.h"
+#include "blending.h"
 #include "texture.h"
 #include "color.h"
 #include "font.h"
 #include "geometry.h"
+#include "utility.h"
 #include "window.h"
-#include <cstring>
+#include <algorithm>
 
 GraphicsContext::GraphicsContext(const Window& window)
 :   window(window),
@@ -13,13 +15,19 @@ GraphicsContext::GraphicsContext(const Window& window)
     framebuffer(SDL_CreateTexture(renderer.get(), SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STREAMING,
                                   window.getResolution().x, window.getResolution().y), SDL_DestroyTexture),
     targetTexture(SDL_PIXELFORMAT_RGBA8888, window.getResolution()),
-    animationFrameTime(10)
+    animationFrameTime(10),
+    renderTarget(&targetTexture),
+    animationFrame(0),
+    maxFrameRate(60),
+    lastFrameTime(0),
+    isRenderingFrame(false)
 {
     if (!renderer)
         throw std::runtime_error(SDL_GetError());
 
     SDL_SetRenderDrawColor(renderer.get(), 0x0, 0x0, 0x0, 0xFF);
     SDL_RenderClear(renderer.get());
+    invalidate();
 }
 
 void GraphicsContext::setScale(double scale)
@@ -28,6 +36,9 @@ void GraphicsContext::setScale(double scale)
     framebuffer.reset(SDL_CreateTexture(renderer.get(), SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STREAMING,
                                         window.getResolution().x, window.getResolution().y));
     targetTexture = Texture(SDL_PIXELFORMAT_RGBA8888, window.getResolution());
+    dirtyRegion = std::nullopt;
+    animatedRegion = std::nullopt;
+    invalidate();
 }
 
 double GraphicsContext::getScale() const
@@ -42,6 +53,70 @@ void GraphicsContext::setAnimationFrameRate(int framesPerSecond)
     animationFrameTime = 1000 / framesPerSecond;
 }
 
+void GraphicsContext::setMaxFrameRate(int framesPerSecond)
+{
+    maxFrameRate = std::max(framesPerSecond, 1);
+}
+
+void GraphicsContext::scheduleFrame(int delay)
+{
+    uint32_t frameTime = SDL_GetTicks() + uint32_t(std::max(delay, 0));
+
+    if (!scheduledFrameTime || frameTime < *scheduledFrameTime)
+        scheduledFrameTime = frameTime;
+}
+
+void GraphicsContext::scheduleFrame(int delay, Rect rectangle)
+{
+    auto region = clipToViewport(mapToTargetCoordinates(rectangle));
+
+    if (!region)
+        return;
+
+    if (scheduledRegion)
+        SDL_UnionRect(reinterpret_cast<const SDL_Rect*>(&*region), reinterpret_cast<const SDL_Rect*>(&*scheduledRegion),
+                      reinterpret_cast<SDL_Rect*>(&*region));
+
+    scheduledRegion = region;
+    scheduleFrame(delay);
+}
+
+std::optional<uint32_t> GraphicsContext::getNextFrameTime() const
+{
+    std::optional<uint32_t> frameTime = scheduledFrameTime;
+
+    if (dirtyRegion)
+        frameTime = 0;
+
+    if (animatedRegion)
+    {
+        uint32_t nextAnimationFrameTime = uint32_t(animationFrame + 1) * uint32_t(animationFrameTime);
+        frameTime = std::min(frameTime.value_or(nextAnimationFrameTime), nextAnimationFrameTime);
+    }
+
+    if (frameTime)
+        return std::max(*frameTime, lastFrameTime + uint32_t(1000 / maxFrameRate));
+
+    return std::nullopt;
+}
+
+bool GraphicsContext::isFrameDue() const
+{
+    auto frameTime = getNextFrameTime();
+    return frameTime && SDL_GetTicks() >= *frameTime;
+}
+
+int GraphicsContext::getTimeUntilNextFrame() const
+{
+    auto frameTime = getNextFrameTime();
+
+    if (!frameTime)
+        return -1;
+
+    uint32_t currentTime = SDL_GetTicks();
+    return *frameTime > currentTime ? int(*frameTime - currentTime) : 0;
+}
+
 void GraphicsContext::setViewport(const Rect* viewport)
 {
     if (viewport)
@@ -55,7 +130,7 @@ Rect GraphicsContext::getViewport() const
     if (viewport)
         return *viewport;
 
-    return Rect(Vector2(0, 0), targetTexture.getSize());
+    return Rect(Vector2(0, 0), renderTarget->getSize());
 }
 
 void GraphicsContext::setView(const Rect* view)
@@ -66,21 +141,115 @@ void GraphicsContext::setView(const Rect* view)
         this->view = std::nullopt;
 }
 
+void GraphicsContext::beginFrame()
+{
+    lastFrameTime = SDL_GetTicks();
+    int currentAnimationFrame = lastFrameTime / animationFrameTime;
+
+    if (scheduledFrameTime && lastFrameTime >= *scheduledFrameTime)
+    {
+        if (scheduledRegion)
+            addDirtyRegion(*scheduledRegion);
+
+        scheduledFrameTime = std::nullopt;
+        scheduledRegion = std::nullopt;
+    }
+
+    if (currentAnimationFrame != animationFrame && animatedRegion)
+    {
+        addDirtyRegion(*animatedRegion);
+        animatedRegion = std::nullopt;
+    }
+
+    animationFrame = currentAnimationFrame;
+    isRenderingFrame = true;
+}
+
 void GraphicsContext::updateScreen()
 {
-    void* pixels;
-    int pitch;
-    int result = SDL_LockTexture(framebuffer.get(), nullptr, &pixels, &pitch);
-    ASSERT(result == 0);
+    isRenderingFrame = false;
 
-    SDL_Surface* surface = targetTexture.surface.get();
-    std::memcpy(pixels, surface->pixels, surface->h * pitch);
+    if (!dirtyRegion)
+        return;
 
-    SDL_UnlockTexture(framebuffer.get());
+    SDL_Surface* surface = targetTexture.surface.get();
+    auto* pixels = static_cast<const uint8_t*>(surface->pixels) + dirtyRegion->getTop() * surface->pitch
+                 + dirtyRegion->getLeft() * surface->format->BytesPerPixel;
+    int result = SDL_UpdateTexture(framebuffer.get(), reinterpret_cast<const SDL_Rect*>(&*dirtyRegion), pixels, surface->pitch);
+    ASSERT(result == 0);
 
     SDL_RenderCopy(renderer.get(), framebuffer.get(), nullptr, nullptr);
     SDL_RenderPresent(renderer.get());
-    clearScreen();
+
+    // Nothing is rendered until the next frame marks a region dirty.
+    dirtyRegion = std::nullopt;
+    SDL_Rect emptyRegion = { 0, 0, 0, 0 };
+    SDL_SetClipRect(surface, &emptyRegion);
+}
+
+void GraphicsContext::markDirty(Rect rectangle)
+{
+    ASSERT(!isRenderingFrame);
+
+    if (auto region = clipToViewport(mapToTargetCoordinates(rectangle)))
+        addDirtyRegion(*region);
+}
+
+void GraphicsContext::invalidate()
+{
+    ASSERT(!isRenderingFrame);
+    addDirtyRegion(Rect(Vector2(0, 0), targetTexture.getSize()));
+}
+
+void GraphicsContext::addDirtyRegion(Rect targetRegion)
+{
+    SDL_Surface* surface = targetTexture.surface.get();
+    SDL_Rect surfaceRegion = { 0, 0, surface->w, surface->h };
+    SDL_Rect region;
+
+    if (!SDL_IntersectRect(reinterpret_cast<const SDL_Rect*>(&targetRegion), &surfaceRegion, &region))
+        return;
+
+    if (dirtyRegion)
+        SDL_UnionRect(&region, reinterpret_cast<const SDL_Rect*>(&*dirtyRegion), &region);
+
+    dirtyRegion = Rect(region.x, region.y, region.w, region.h);
+    SDL_SetClipRect(surface, &region);
+    SDL_FillRect(surface, &region, 0);
+}
+
+bool GraphicsContext::isDirty(Rect rectangle) const
+{
+    if (!dirtyRegion)
+        return false;
+
+    rectangle = mapToTargetCoordinates(rectangle);
+    return SDL_HasIntersection(reinterpret_cast<const SDL_Rect*>(&rectangle), reinterpret_cast<const SDL_Rect*>(&*dirtyRegion));
+}
+
+void GraphicsContext::markAnimated(Rect rectangle)
+{
+    auto region = clipToViewport(mapToTargetCoordinates(rectangle));
+
+    if (!region)
+        return;
+
+    if (animatedRegion)
+        SDL_UnionRect(reinterpret_cast<const SDL_Rect*>(&*region), reinterpret_cast<const SDL_Rect*>(&*animatedRegion),
+                      reinterpret_cast<SDL_Rect*>(&*region));
+
+    animatedRegion = region;
+}
+
+std::optional<Rect> GraphicsContext::clipToViewport(Rect rectangle) const
+{
+    auto viewport = getViewport();
+
+    if (!SDL_IntersectRect(reinterpret_cast<const SDL_Rect*>(&rectangle), reinterpret_cast<const SDL_Rect*>(&viewport),
+                           reinterpret_cast<SDL_Rect*>(&rectangle)))
+        return std::nullopt;
+
+    return rectangle;
 }
 
 void GraphicsContext::clearScreen()
@@ -88,6 +257,24 @@ void GraphicsContext::clearScreen()
     SDL_FillRect(targetTexture.surface.get(), nullptr, 0);
 }
 
+void GraphicsContext::renderToTexture(Texture& texture, const std::function<void()>& render)
+{
+    auto oldView = view;
+    auto oldViewport = viewport;
+    auto* oldRenderTarget = renderTarget;
+    DEFER
+    {
+        view = oldView;
+        viewport = oldViewport;
+        renderTarget = oldRenderTarget;
+    };
+
+    view = std::nullopt;
+    viewport = std::nullopt;
+    renderTarget = &texture;
+    render();
+}
+
 Vector2 GraphicsContext::mapFromTargetCoordinates(Vector2 position) const
 {
     position /= getScale();
@@ -117,10 +304,10 @@ void GraphicsContext::renderRectangle(Rect rectangle, Color color)
     SDL_Rect bottomLine = { rectangle.getLeft(), rectangle.getBottom(), rectangle.getWidth(), 1 };
     SDL_Rect leftLine = { rectangle.getLeft(), rectangle.getTop(), 1, rectangle.getHeight() };
     SDL_Rect rightLine = { rectangle.getRight(), rectangle.getTop(), 1, rectangle.getHeight() };
-    SDL_FillRect(targetTexture.surface.get(), &topLine, color.intValue());
-    SDL_FillRect(targetTexture.surface.get(), &bottomLine, color.intValue());
-    SDL_FillRect(targetTexture.surface.get(), &leftLine, color.intValue());
-    SDL_FillRect(targetTexture.surface.get(), &rightLine, color.intValue());
+    SDL_FillRect(getTargetSurface(), &topLine, color.intValue());
+    SDL_FillRect(getTargetSurface(), &bottomLine, color.intValue());
+    SDL_FillRect(getTargetSurface(), &leftLine, color.intValue());
+    SDL_FillRect(getTargetSurface(), &rightLine, color.intValue());
 }
 
 void GraphicsContext::renderFilledRectangle(Rect rectangle, Color color, BlendMode blendMode)
@@ -130,46 +317,26 @@ void GraphicsContext::renderFilledRectangle(Rect rectangle, Color color, BlendMo
     switch (blendMode)
     {
         case BlendMode::Normal:
-            SDL_FillRect(targetTexture.surface.get(), reinterpret_cast<const SDL_Rect*>(&rectangle), color.intValue());
+            SDL_FillRect(getTargetSurface(), reinterpret_cast<const SDL_Rect*>(&rectangle), color.intValue());
             break;
 
         case BlendMode::LinearLight:
-            SDL_Surface* targetSurface = targetTexture.surface.get();
-            auto left = rectangle.getLeft();
-            auto top = rectangle.getTop();
-            auto right = rectangle.getRight();
-            auto bottom = rectangle.getBottom();
+            SDL_Surface* targetSurface = getTargetSurface();
+            const SDL_Rect& clipRect = targetSurface->clip_rect;
+            auto left = std::max(rectangle.getLeft(), clipRect.x);
+            auto top = std::max(rectangle.getTop(), clipRect.y);
+            auto right = std::min(rectangle.getRight(), clipRect.x + clipRect.w - 1);
+            auto bottom = std::min(rectangle.getBottom(), clipRect.y + clipRect.h - 1);
 
-            if (left < 0 || top < 0 || right >= targetSurface->w || bottom >= targetSurface->h)
+            if (left > right || top > bottom)
                 return;
 
-            float dstR = color.r / 255.0f;
-            float dstG = color.g / 255.0f;
-            float dstB = color.b / 255.0f;
             uint32_t* pixels = static_cast<uint32_t*>(targetSurface->pixels);
             auto targetWidth = targetSurface->w;
 
             for (auto y = top; y <= bottom; ++y)
-            {
-                for (auto x = left; x <= right; ++x)
-                {
-                    uint32_t* pixel = pixels + (y * targetWidth + x);
-
-                    float srcR = ((*pixel & 0xFF000000) >> 24) / 255.0f;
-                    float srcG = ((*pixel & 0x00FF0000) >> 16) / 255.0f;
-                    float srcB = ((*pixel & 0x0000FF00) >> 8) / 255.0f;
-
-                    srcR = (dstR > 0.5f) * (srcR + 2.0f * (dstR - 0.5f)) + (dstR <= 0.5f) * (srcR + 2.0f * dstR - 1.0f);
-                    srcG = (dstG > 0.5f) * (srcG + 2.0f * (dstG - 0.5f)) + (dstG <= 0.5f) * (srcG + 2.0f * dstG - 1.0f);
-                    srcB = (dstB > 0.5f) * (srcB + 2.0f * (dstB - 0.5f)) + (dstB <= 0.5f) * (srcB + 2.0f * dstB - 1.0f);
-
-                    srcR = srcR < 0.0f ? 0.0f : srcR > 1.0f ? 1.0f : srcR;
-                    srcG = srcG < 0.0f ? 0.0f : srcG > 1.0f ? 1.0f : srcG;
-                    srcB = srcB < 0.0f ? 0.0f : srcB > 1.0f ? 1.0f : srcB;
-
-                    *pixel = uint32_t(255 * srcR) << 24 | uint32_t(255 * srcG) << 16 | uint32_t(255 * srcB) << 8 | 255;
-                }
-            }
+                blendLinearLight(pixels + (y * targetWidth + left), right - left + 1, color);
+
             break;
     }
 }
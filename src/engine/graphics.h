@@ -4,6 +4,7 @@
 #include "geometry.h"
 #include "texture.h"
 #include <SDL.h>
+#include <functional>
 #include <optional>
 #include <memory>
 
@@ -23,10 +24,39 @@ public:
     void setScale(double scale);
     double getScale() const;
     void setAnimationFrameRate(int framesPerSecond);
+    /// Limits how often Window::waitForInput renders a new frame.
+    void setMaxFrameRate(int framesPerSecond);
+    int getMaxFrameRate() const { return maxFrameRate; }
+    /// Requests a frame to be rendered after `delay` milliseconds, even if nothing else changes.
+    void scheduleFrame(int delay);
+    /// Requests a region, given in view coordinates, to be redrawn after `delay` milliseconds.
+    void scheduleFrame(int delay, Rect rectangle);
+    /// Returns true if something on the screen has changed and the frame rate limit allows a new frame.
+    bool isFrameDue() const;
+    /// Returns the number of milliseconds until the next frame is due, or -1 if no frame is needed
+    /// until the next input event.
+    int getTimeUntilNextFrame() const;
+    /// Prepares the dirty region for rendering a new frame. Regions containing animated sprites
+    /// are redrawn whenever the animation advances to the next frame.
+    void beginFrame();
+    /// Uploads the dirty region to the screen. The rest of the screen keeps its previous contents.
     void updateScreen();
+    /// Marks a region, given in view coordinates, to be cleared and redrawn in the next frame. Must
+    /// not be called while a frame is being rendered, since the region is cleared right away.
+    void markDirty(Rect rectangle);
+    /// Marks the whole screen to be redrawn in the next frame.
+    void invalidate();
+    /// Returns true if any part of a region, given in view coordinates, is redrawn in the current
+    /// frame. Rendering is clipped to the dirty region, so other regions can be skipped entirely.
+    bool isDirty(Rect rectangle) const;
+    /// Records a region, given in view coordinates, that contains an animated sprite.
+    void markAnimated(Rect rectangle);
     void renderRectangle(Rect rectangle, Color color);
     void renderFilledRectangle(Rect rectangle, Color color, BlendMode blendMode = BlendMode::Normal);
     void clearScreen();
+    /// Calls `render` with rendering redirected to `texture`, with no view or viewport set.
+    void renderToTexture(Texture& texture, const std::function<void()>& render);
+    SDL_Surface* getTargetSurface() const { return renderTarget->surface.get(); }
     Vector2 mapFromTargetCoordinates(Vector2) const;
     Rect mapToTargetCoordinates(Rect) const;
 
@@ -38,4 +68,24 @@ public:
     std::optional<Rect> view;
     BitmapFont* font;
     int animationFrameTime;
+
+private:
+    void addDirtyRegion(Rect targetRegion);
+    std::optional<Rect> clipToViewport(Rect rectangle) const;
+    std::optional<uint32_t> getNextFrameTime() const;
+
+    /// The texture rendered to, which is targetTexture unless rendering to another texture.
+    Texture* renderTarget;
+    /// The bounding box of the regions to redraw in the current frame, in target coordinates.
+    std::optional<Rect> dirtyRegion;
+    /// The bounding box of the animated sprites rendered since the animation last advanced.
+    std::optional<Rect> animatedRegion;
+    int animationFrame;
+    int maxFrameRate;
+    uint32_t lastFrameTime;
+    std::optional<uint32_t> scheduledFrameTime;
+    /// The bounding box of the regions to redraw when the scheduled frame is rendered.
+    std::optional<Rect> scheduledRegion;
+    /// Set between beginFrame and updateScreen.
+    bool isRenderingFrame;
 };
@@ -1,6 +1,7 @@
 #include "keyboard.h"
 #include "font.h"
 #include "geometry.h"
+#include "state.h"
 #include "window.h"
 #include <SDL.h>
 #include <cctype>
@@ -24,17 +25,31 @@ int keyboard::readLine(Window& window, std::string& line, Vector2 position,
 {
     BitmapFont& font = *window.context.font;
     std::string::iterator cursor = line.end();
+    Rect lineArea(position, window.getResolution() - position);
     SDL_Event event;
+    window.context.markDirty(lineArea);
 
     while (true)
     {
+        window.stateManager->markChangedRegions();
         render();
-        font.setArea(Rect(position, window.getResolution() - position));
+        font.setArea(lineArea);
         font.print(window, prefix);
         font.printWithCursor(window, line, cursor == line.end() ? nullptr : &*cursor);
         window.context.updateScreen();
         SDL_WaitEvent(&event);
 
+        if (event.type == SDL_MOUSEMOTION)
+            window.stateManager->onMouseMove();
+        else if (event.type == SDL_WINDOWEVENT)
+            window.handleWindowEvent(event.window.event);
+
+        if (event.type != SDL_KEYDOWN)
+            continue;
+
+        // Redraw the line as it's edited, and erase it once it's done.
+        window.context.markDirty(lineArea);
+
         if (auto unhandledKey = readLineProcessKey(event, line, cursor))
             return unhandledKey;
     }
@@ -8,7 +8,7 @@ const Vector2 directionVectors[] =
     {0, 0}, {1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1}
 };
 
-RNG rng;
+thread_local RNG rng;
 
 template<>
 RNG::result_type randInt(RNG::result_type max)
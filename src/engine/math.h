@@ -1,8 +1,10 @@
 #pragma once
 
 #include "assert.h"
+#include <cstdint>
 #include <limits>
 #include <random>
+#include <utility>
 
 template<typename T>
 T sign(T value)
@@ -10,8 +12,37 @@ T sign(T value)
     return (value > 0) - (value < 0);
 }
 
+/// Returns the index of the lowest set bit of a nonzero value.
+inline int countTrailingZeros(uint64_t value)
+{
+    ASSERT(value != 0);
+#ifdef __GNUC__
+    return __builtin_ctzll(value);
+#else
+    int count = 0;
+
+    for (; !(value & 1); value >>= 1)
+        ++count;
+
+    return count;
+#endif
+}
+
 using RNG = std::mt19937;
-extern RNG rng;
+extern thread_local RNG rng;
+
+/// Replaces the calling thread's `rng` with the given generator until the end of the scope.
+class ScopedRNG
+{
+public:
+    ScopedRNG(RNG&& scopedRNG) : previousRNG(std::move(rng)) { rng = std::move(scopedRNG); }
+    ~ScopedRNG() { rng = std::move(previousRNG); }
+    ScopedRNG(const ScopedRNG&) = delete;
+    ScopedRNG& operator=(const ScopedRNG&) = delete;
+
+private:
+    RNG previousRNG;
+};
 
 template<typename T> T randInt(T max = std::numeric_limits<T>::max());
 template<typename T> T randInt(T min, T max);
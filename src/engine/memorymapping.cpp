@@ -0,0 +1,105 @@
+#include "memorymapping.h"
+#include <stdexcept>
+#include <string>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MemoryMapping::MemoryMapping(std::string_view filePath)
+{
+    fileHandle = CreateFileA(std::string(filePath).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                             OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (fileHandle == INVALID_HANDLE_VALUE)
+        throw std::runtime_error("Unable to open " + std::string(filePath));
+
+    LARGE_INTEGER fileSize;
+
+    if (!GetFileSizeEx(fileHandle, &fileSize))
+    {
+        CloseHandle(fileHandle);
+        throw std::runtime_error("Unable to get the size of " + std::string(filePath));
+    }
+
+    size = size_t(fileSize.QuadPart);
+
+    if (size == 0)
+        return;
+
+    mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    data = mappingHandle ? static_cast<const char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+
+    if (!data)
+    {
+        if (mappingHandle)
+            CloseHandle(mappingHandle);
+
+        CloseHandle(fileHandle);
+        throw std::runtime_error("Unable to map " + std::string(filePath) + " into memory");
+    }
+}
+
+MemoryMapping::~MemoryMapping()
+{
+    if (data)
+        UnmapViewOfFile(data);
+
+    if (mappingHandle)
+        CloseHandle(mappingHandle);
+
+    CloseHandle(fileHandle);
+}
+
+#else
+
+MemoryMapping::MemoryMapping(std::string_view filePath)
+{
+    int fileDescriptor = open(std::string(filePath).c_str(), O_RDONLY);
+
+    if (fileDescriptor == -1)
+        throw std::runtime_error("Unable to open " + std::string(filePath));
+
+    struct stat fileStatus;
+
+    if (fstat(fileDescriptor, &fileStatus) == -1)
+    {
+        close(fileDescriptor);
+        throw std::runtime_error("Unable to get the size of " + std::string(filePath));
+    }
+
+    size = size_t(fileStatus.st_size);
+
+    if (size != 0)
+    {
+        void* address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+
+        if (address == MAP_FAILED)
+        {
+            close(fileDescriptor);
+            throw std::runtime_error("Unable to map " + std::string(filePath) + " into memory");
+        }
+
+        data = static_cast<const char*>(address);
+    }
+
+    // The mapping stays valid after the file descriptor is closed.
+    close(fileDescriptor);
+}
+
+MemoryMapping::~MemoryMapping()
+{
+    if (data)
+        munmap(const_cast<char*>(data), size);
+}
+
+#endif
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+/// A read-only mapping of a whole file into memory. Pages of the file are read from disk only when
+/// they're first accessed.
+class MemoryMapping
+{
+public:
+    explicit MemoryMapping(std::string_view filePath);
+    ~MemoryMapping();
+    MemoryMapping(const MemoryMapping&) = delete;
+    MemoryMapping& operator=(const MemoryMapping&) = delete;
+    const char* getData() const { return data; }
+    size_t getSize() const { return size; }
+
+private:
+    const char* data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+};
@@ -94,6 +94,18 @@ StateChange Menu::update()
     }
 }
 
+void Menu::onMouseMove()
+{
+    // The hovered item is highlighted.
+    markDirty();
+}
+
+void Menu::markDirty() const
+{
+    for (auto& itemPosition : itemPositions)
+        window->context.markDirty(itemPosition);
+}
+
 int Menu::calculateMaxTextSize() const
 {
     unsigned maxSize = 0;
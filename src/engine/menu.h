@@ -26,6 +26,7 @@ public:
     void clear();
     StateChange update() override;
     void render() override;
+    void onMouseMove() override;
     void setHotkeyStyle(HotkeyStyle style) { hotkeyStyle = style; }
     void setTextLayout(TextLayout layout) { textLayout = layout; }
     void setItemLayout(ItemLayout layout) { itemLayout = layout; }
@@ -36,6 +37,10 @@ public:
     void setArea(Vector2 position, Vector2 size) { area = Rect(position, size); }
     static void setDefaultTextColor(Color color) { defaultTextColor = color; }
 
+protected:
+    /// Marks the items of the menu to be redrawn, e.g. after their texts have changed.
+    void markDirty() const;
+
 private:
     bool isValidIndex(unsigned index) const { return index < menuItems.size(); }
     int calculateMaxTextSize() const;
@@ -5,8 +5,8 @@
 /// Calls `handler` with each point on a line from `source` to `target` as determined by Bresenham's
 /// line algorithm. Stops processing and returns false if `handler` returns false. Otherwise returns
 /// true after processing all points.
-template<typename T>
-bool raycast(Vector2 source, Vector2 target, bool (*handler)(Vector2, T*), T* data)
+template<typename Handler>
+bool raycast(Vector2 source, Vector2 target, Handler handler)
 {
     const Vector2 delta = target - source;
     const Vector2 sign = ::sign(delta);
@@ -27,7 +27,7 @@ bool raycast(Vector2 source, Vector2 target, bool (*handler)(Vector2, T*), T* da
             current.x += sign.x;
             slope += abs.y;
 
-            if (!handler(current, data))
+            if (!handler(current))
                 return false;
         }
     }
@@ -44,7 +44,7 @@ bool raycast(Vector2 source, Vector2 target, bool (*handler)(Vector2, T*), T* da
             current.y += sign.y;
             slope += abs.x;
 
-            if (!handler(current, data))
+            if (!handler(current))
                 return false;
         }
     }
@@ -54,7 +54,7 @@ bool raycast(Vector2 source, Vector2 target, bool (*handler)(Vector2, T*), T* da
         {
             current += sign;
 
-            if (!handler(current, data))
+            if (!handler(current))
                 return false;
         }
     }
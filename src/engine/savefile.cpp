@@ -1,7 +1,7 @@
 #include "savefile.h"
 #include "assert.h"
 #include <SDL.h>
-#include <climits>
+#include <algorithm>
 #include <cstring>
 #include <stdexcept>
 
@@ -11,24 +11,31 @@ static void closeFile(SDL_RWops* file)
 }
 
 SaveFile::SaveFile(std::string_view filePath, bool writable)
-:   file(SDL_RWFromFile(std::string(filePath).c_str(), writable ? "wb" : "rb"), closeFile)
+:   file(nullptr, closeFile)
 {
+    if (!writable)
+    {
+        mapping = std::make_unique<const MemoryMapping>(filePath);
+        return;
+    }
+
+    file.reset(SDL_RWFromFile(std::string(filePath).c_str(), "wb"));
+
     if (!file)
         throw std::runtime_error(SDL_GetError());
 }
 
 SaveFile::SaveFile(std::vector<char> buffer)
 :   buffer(std::move(buffer)),
-    file(SDL_RWFromMem(this->buffer.data(), static_cast<int>(this->buffer.size())), closeFile)
+    file(nullptr, closeFile)
 {
-    ASSERT(this->buffer.size() <= INT_MAX && "SDL_RWFromMem size overflow");
-
-    if (!file)
-        throw std::runtime_error(SDL_GetError());
 }
 
 uint64_t SaveFile::getSize() const
 {
+    if (!file)
+        return getMemorySize();
+
     auto size = SDL_RWsize(file.get());
 
     if (size < 0)
@@ -39,52 +46,140 @@ uint64_t SaveFile::getSize() const
 
 int64_t SaveFile::getOffset() const
 {
+    if (!file)
+        return int64_t(memoryOffset);
+
     return SDL_RWtell(file.get());
 }
 
 void SaveFile::seek(int64_t offset)
 {
+    if (!file)
+    {
+        ASSERT(offset >= 0);
+        memoryOffset = size_t(offset);
+        return;
+    }
+
     SDL_RWseek(file.get(), offset, RW_SEEK_SET);
 }
 
+std::vector<char> SaveFile::takeBuffer()
+{
+    ASSERT(!file && !mapping);
+    memoryOffset = 0;
+    return std::move(buffer);
+}
+
+void SaveFile::close()
+{
+    ASSERT(file);
+
+    if (SDL_RWclose(file.release()) != 0)
+        throw std::runtime_error(SDL_GetError());
+}
+
+void SaveFile::writeBytes(const void* data, size_t size)
+{
+    if (file)
+    {
+        if (SDL_RWwrite(file.get(), data, 1, size) != size)
+            throw std::runtime_error(SDL_GetError());
+
+        return;
+    }
+
+    ASSERT(!mapping);
+
+    if (memoryOffset + size > buffer.size())
+        buffer.resize(memoryOffset + size);
+
+    std::memcpy(buffer.data() + memoryOffset, data, size);
+    memoryOffset += size;
+}
+
+void SaveFile::readBytes(void* data, size_t size) const
+{
+    if (file)
+    {
+        if (SDL_RWread(file.get(), data, 1, size) != size)
+            throw std::runtime_error("Unexpected end of save file");
+
+        return;
+    }
+
+    if (size == 0)
+        return;
+
+    if (size > getMemorySize() - std::min(memoryOffset, getMemorySize()))
+        throw std::runtime_error("Unexpected end of save file");
+
+    std::memcpy(data, getMemory() + memoryOffset, size);
+    memoryOffset += size;
+}
+
+template<typename T>
+static void writeLittleEndian(SaveFile& file, T value)
+{
+    uint8_t bytes[sizeof(T)];
+
+    for (size_t i = 0; i < sizeof(T); ++i)
+        bytes[i] = uint8_t(value >> (i * 8));
+
+    file.writeBytes(bytes, sizeof(T));
+}
+
+template<typename T>
+static T readLittleEndian(const SaveFile& file)
+{
+    uint8_t bytes[sizeof(T)];
+    file.readBytes(bytes, sizeof(T));
+    T value = 0;
+
+    for (size_t i = 0; i < sizeof(T); ++i)
+        value |= T(T(bytes[i]) << (i * 8));
+
+    return value;
+}
+
 void SaveFile::writeInt8(uint8_t value)
 {
-    SDL_WriteU8(file.get(), value);
+    writeLittleEndian(*this, value);
 }
 
 uint8_t SaveFile::readUint8() const
 {
-    return SDL_ReadU8(file.get());
+    return readLittleEndian<uint8_t>(*this);
 }
 
 void SaveFile::writeInt16(uint16_t value)
 {
-    SDL_WriteLE16(file.get(), value);
+    writeLittleEndian(*this, value);
 }
 
 uint16_t SaveFile::readUint16() const
 {
-    return SDL_ReadLE16(file.get());
+    return readLittleEndian<uint16_t>(*this);
 }
 
 void SaveFile::writeInt32(uint32_t value)
 {
-    SDL_WriteLE32(file.get(), value);
+    writeLittleEndian(*this, value);
 }
 
 uint32_t SaveFile::readUint32() const
 {
-    return SDL_ReadLE32(file.get());
+    return readLittleEndian<uint32_t>(*this);
 }
 
 void SaveFile::writeInt64(uint64_t value)
 {
-    SDL_WriteLE64(file.get(), value);
+    writeLittleEndian(*this, value);
 }
 
 uint64_t SaveFile::readUint64() const
 {
-    return SDL_ReadLE64(file.get());
+    return readLittleEndian<uint64_t>(*this);
 }
 
 void SaveFile::write(bool value)
@@ -117,20 +212,14 @@ double SaveFile::readDouble() const
 void SaveFile::write(std::string_view value)
 {
     writeInt16(uint16_t(value.size()));
-
-    for (auto ch : value)
-        writeInt8(uint8_t(ch));
+    writeBytes(value.data(), value.size());
 }
 
 std::string SaveFile::readString() const
 {
     auto size = readUint16();
-    std::string string;
-    string.reserve(size);
-
-    for (int i = 0; i < size; ++i)
-        string += char(readUint8());
-
+    std::string string(size, '\0');
+    readBytes(&string[0], size);
     return string;
 }
 
@@ -161,21 +250,3 @@ Vector3 SaveFile::readVector3() const
     auto z = readInt32();
     return Vector3(x, y, z);
 }
-
-SaveFile SaveFile::copyToMemory()
-{
-    auto offset = getOffset();
-    seek(0);
-    auto size = getSize();
-    std::vector<char> buffer(size);
-    size_t bytesRead = SDL_RWread(file.get(), buffer.data(), 1, size);
-
-    if (bytesRead == 0)
-        throw std::runtime_error(SDL_GetError());
-
-    if (bytesRead != size)
-        throw std::runtime_error("SDL_RWread didn't read the requested number of bytes");
-
-    seek(offset);
-    return SaveFile(std::move(buffer));
-}
@@ -2,6 +2,7 @@
 
 #include "assert.h"
 #include "geometry.h"
+#include "memorymapping.h"
 #include <string_view>
 #include <memory>
 #include <vector>
@@ -11,11 +12,21 @@ struct SDL_RWops;
 class SaveFile
 {
 public:
+    /// Opens a save file for writing, or for reading directly from a memory mapping of the file.
     SaveFile(std::string_view filePath, bool writable);
+    /// Creates a save file that reads from the given buffer, or if the buffer is empty, writes to a
+    /// buffer that grows as needed.
+    explicit SaveFile(std::vector<char> buffer = {});
     uint64_t getSize() const;
     int64_t getOffset() const;
     void seek(int64_t offset);
-    SaveFile copyToMemory();
+    /// Returns the contents of an in-memory save file, leaving it empty.
+    std::vector<char> takeBuffer();
+    /// Closes a save file opened for writing, throwing if the remaining data couldn't be written.
+    void close();
+
+    void writeBytes(const void* data, size_t size);
+    void readBytes(void* data, size_t size) const;
 
     void writeInt8(int8_t value) { writeInt8(uint8_t(value)); }
     void writeInt8(uint8_t value);
@@ -51,7 +62,6 @@ public:
     void read(std::vector<T>& vector) const;
 
 private:
-    SaveFile(std::vector<char> buffer);
     template<typename T>
     void write(const std::unique_ptr<T>& value) { value->save(*this); }
     template<typename T>
@@ -59,7 +69,12 @@ private:
     template<typename T>
     T read() const { return T::load(*this); }
 
+    const char* getMemory() const { return mapping ? mapping->getData() : buffer.data(); }
+    size_t getMemorySize() const { return mapping ? mapping->getSize() : buffer.size(); }
+
     std::vector<char> buffer;
+    std::unique_ptr<const MemoryMapping> mapping;
+    mutable size_t memoryOffset = 0;
     std::unique_ptr<SDL_RWops, void (&)(SDL_RWops*)> file;
 };
 
@@ -27,4 +27,7 @@ void Sprite::render(Window& window, Vector2 position, Vector2 sourceOffset) cons
         texture->render(window, source, target, materialColor);
     else
         texture->render(window, source, target);
+
+    if (animationFrames > 1)
+        window.context.markAnimated(target);
 }
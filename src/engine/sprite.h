@@ -18,6 +18,7 @@ public:
     Color getMaterialColor() const { return materialColor; }
     void setMaterialColor(Color color) { materialColor = color; }
     void setFrame(int newFrame) { frame = newFrame; }
+    bool isAnimated() const { return animationFrames > 1; }
 
 private:
     const Texture* texture;
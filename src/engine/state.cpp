@@ -76,9 +76,16 @@ StateChange::Result StateManager::wait()
 
     while (states.size() >= oldStates)
     {
-        // FIXME: These are duplicated in PlayerController::control().
-        render();
-        window->context.updateScreen();
+        markChangedRegions();
+
+        // Render pending changes without waiting for the frame rate limit, since update() may block
+        // for a while before anything is rendered again.
+        if (window->context.getTimeUntilNextFrame() >= 0)
+        {
+            window->context.beginFrame();
+            render();
+            window->context.updateScreen();
+        }
 
         if (auto result = handleStateChange(currentState()->update()))
             return result;
@@ -120,6 +127,22 @@ void StateManager::render() const
     currentState()->render();
 }
 
+void StateManager::markChangedRegions() const
+{
+    if (currentState()->renderPreviousState())
+        previousState()->markChangedRegions();
+
+    currentState()->markChangedRegions();
+}
+
+void StateManager::onMouseMove() const
+{
+    if (currentState()->renderPreviousState())
+        previousState()->onMouseMove();
+
+    currentState()->onMouseMove();
+}
+
 void StateManager::operator()(StateChange::None&)
 {
 }
@@ -127,11 +150,13 @@ void StateManager::operator()(StateChange::None&)
 void StateManager::operator()(StateChange::Push& push)
 {
     pushState(std::move(push.newState));
+    window->context.invalidate();
 }
 
 void StateManager::operator()(StateChange::Pop&)
 {
     states.pop_back();
+    window->context.invalidate();
 }
 
 StateChange::Result StateManager::handleStateChange(StateChange stateChange)
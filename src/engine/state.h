@@ -73,6 +73,11 @@ public:
     virtual StateChange update() { return StateChange::None(); }
     virtual StateChange onKeyDown(Key) { return StateChange::None(); }
     virtual StateChange onEvent(Event) { return StateChange::None(); }
+    /// Called before each frame, to mark the regions of the screen whose contents have changed since
+    /// the previous call. The state marks them itself, as only it knows what it renders where.
+    virtual void markChangedRegions() {}
+    /// Called when the mouse moves, to mark the regions whose contents depend on the mouse position.
+    virtual void onMouseMove() {}
 
     StateManager* stateManager = nullptr;
     Window* window = nullptr;
@@ -85,6 +90,8 @@ public:
     StateChange::Result wait();
     StateChange::Result getResult(StateChange stateChange);
     void render() const;
+    void markChangedRegions() const;
+    void onMouseMove() const;
 
     void operator()(StateChange::None& none);
     void operator()(StateChange::Push& push);
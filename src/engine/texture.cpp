@@ -3,6 +3,7 @@
 #include "utility.h"
 #include "window.h"
 #include <SDL.h>
+#include <algorithm>
 #include <stdexcept>
 
 struct PixelFormatMasks
@@ -76,22 +77,66 @@ void Texture::render(Window& window, Rect source, Rect target) const
 
     SDL_BlitSurface(surface.get(),
                     reinterpret_cast<SDL_Rect*>(&source),
-                    window.context.targetTexture.surface.get(),
+                    window.context.getTargetSurface(),
                     reinterpret_cast<SDL_Rect*>(&target));
 }
 
 void Texture::render(Window& window, Rect source, Rect target, Color materialColor) const
 {
     target = window.context.mapToTargetCoordinates(target);
+    Rect recoloredSource(Vector2::zero, source.size);
+
+    SDL_BlitSurface(getRecoloredSurface(source, materialColor),
+                    reinterpret_cast<SDL_Rect*>(&recoloredSource),
+                    window.context.getTargetSurface(),
+                    reinterpret_cast<SDL_Rect*>(&target));
+}
+
+SDL_Surface* Texture::getRecoloredSurface(Rect source, Color materialColor) const
+{
+    ++recoloringClock;
+    RecoloredRegion region { source, materialColor.intValue() };
+    auto it = recoloredSurfaces.find(region);
+
+    if (it != recoloredSurfaces.end())
+    {
+        it->second.lastUsed = recoloringClock;
+        return it->second.surface.get();
+    }
+
+    auto surfaceSize = size_t(source.getArea()) * sizeof(uint32_t);
+
+    while (!recoloredSurfaces.empty() && recoloredSurfacesSize + surfaceSize > recoloredSurfacesBudget)
+    {
+        auto leastRecentlyUsed = std::min_element(recoloredSurfaces.begin(), recoloredSurfaces.end(), [](auto& a, auto& b)
+        {
+            return a.second.lastUsed < b.second.lastUsed;
+        });
+
+        recoloredSurfacesSize -= size_t(leastRecentlyUsed->first.source.getArea()) * sizeof(uint32_t);
+        recoloredSurfaces.erase(leastRecentlyUsed);
+    }
+
+    RecoloredSurface recoloredSurface { { createRecoloredSurface(source, materialColor), SDL_FreeSurface }, recoloringClock };
+    recoloredSurfacesSize += surfaceSize;
+    return recoloredSurfaces.emplace(region, std::move(recoloredSurface)).first->second.surface.get();
+}
+
+SDL_Surface* Texture::createRecoloredSurface(Rect source, Color materialColor) const
+{
+    SDL_Surface* recolored = createSurfaceWithFormat(surface->format->format, source.size);
+
+    if (!recolored)
+        throw std::runtime_error(std::string("SDL_CreateRGBSurface: ") + SDL_GetError());
 
-    SDL_Surface* targetSurface = window.context.targetTexture.surface.get();
     const uint32_t* sourcePixels = static_cast<const uint32_t*>(surface->pixels);
-    uint32_t* targetPixels = static_cast<uint32_t*>(targetSurface->pixels);
+    uint32_t* recoloredPixels = static_cast<uint32_t*>(recolored->pixels);
     auto sourceWidth = surface->w;
-    auto targetWidth = targetSurface->w;
+    auto recoloredWidth = recolored->pitch / int(sizeof(uint32_t));
 
     uint32_t transparentColor;
-    if (SDL_GetColorKey(surface.get(), &transparentColor) != 0)
+    bool hasColorKey = SDL_GetColorKey(surface.get(), &transparentColor) == 0;
+    if (!hasColorKey)
         transparentColor = 0;
 
     for (auto y = source.getTop(); y <= source.getBottom(); ++y)
@@ -100,23 +145,30 @@ void Texture::render(Window& window, Rect source, Rect target, Color materialCol
         {
             uint32_t pixel = sourcePixels[y * sourceWidth + x];
 
-            if (pixel == transparentColor)
-                continue;
-
-            const uint8_t* abgr = reinterpret_cast<const uint8_t*>(&sourcePixels[y * sourceWidth + x]);
-            bool isMagenta = abgr[3] > 0 && abgr[3] == abgr[1] && abgr[2] == 0;
-
-            if (isMagenta)
+            if (pixel != transparentColor)
             {
-                auto brightness = abgr[3] / 128.0;
-                pixel = (materialColor * brightness).intValue();
+                const uint8_t* abgr = reinterpret_cast<const uint8_t*>(&sourcePixels[y * sourceWidth + x]);
+                bool isMagenta = abgr[3] > 0 && abgr[3] == abgr[1] && abgr[2] == 0;
+
+                if (isMagenta)
+                {
+                    auto brightness = abgr[3] / 128.0;
+                    pixel = (materialColor * brightness).intValue();
+                }
             }
 
-            auto targetY = y - source.getTop() + target.getTop();
-            auto targetX = x - source.getLeft() + target.getLeft();
-            targetPixels[targetY * targetWidth + targetX] = pixel;
+            recoloredPixels[(y - source.getTop()) * recoloredWidth + x - source.getLeft()] = pixel;
         }
     }
+
+    // The pixels are copied as is, skipping only the transparent ones, like when they were drawn
+    // directly into the target. SDL matches color keys on RGB only, so a surface without a key
+    // must not get one, or its black pixels would be skipped too.
+    if (hasColorKey)
+        SDL_SetColorKey(recolored, 1, transparentColor);
+
+    SDL_SetSurfaceBlendMode(recolored, SDL_BLENDMODE_NONE);
+    return recolored;
 }
 
 Vector2 Texture::getSize() const
@@ -4,6 +4,7 @@
 #include "geometry.h"
 #include <SDL.h>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 struct SDL_Renderer;
@@ -22,10 +23,49 @@ public:
     void render(Window& window, Vector2 position, Vector2 size = Vector2::zero) const;
     void render(Window& window, Rect target) const;
     void render(Window& window, Rect source, Rect target) const;
+    /// Renders the region with its magenta shades replaced by shades of `materialColor`. The
+    /// recolored region is cached, so it's only computed on the first render.
     void render(Window& window, Rect source, Rect target, Color materialColor) const;
     Vector2 getSize() const;
     int getWidth() const;
     int getHeight() const;
 
     std::unique_ptr<SDL_Surface, void (*)(SDL_Surface*)> surface;
+
+private:
+    struct RecoloredRegion
+    {
+        Rect source;
+        uint32_t materialColor;
+
+        bool operator==(const RecoloredRegion& other) const
+        {
+            return source.position == other.source.position && source.size == other.source.size
+                && materialColor == other.materialColor;
+        }
+    };
+
+    struct RecoloredRegionHash
+    {
+        size_t operator()(const RecoloredRegion& region) const
+        {
+            return std::hash<Vector2>()(region.source.position) ^ (size_t(region.materialColor) * 2654435761u);
+        }
+    };
+
+    struct RecoloredSurface
+    {
+        std::unique_ptr<SDL_Surface, void (*)(SDL_Surface*)> surface;
+        uint64_t lastUsed;
+    };
+
+    SDL_Surface* getRecoloredSurface(Rect source, Color materialColor) const;
+    SDL_Surface* createRecoloredSurface(Rect source, Color materialColor) const;
+
+    mutable std::unordered_map<RecoloredRegion, RecoloredSurface, RecoloredRegionHash> recoloredSurfaces;
+    mutable size_t recoloredSurfacesSize = 0;
+    mutable uint64_t recoloringClock = 0;
+    /// The number of bytes of recolored pixels kept per texture before the least recently used
+    /// ones are discarded.
+    static const size_t recoloredSurfacesBudget = 4 * 1024 * 1024;
 };
@@ -0,0 +1,95 @@
+#include "threadpool.h"
+#include "assert.h"
+#include <utility>
+
+ThreadPool::ThreadPool(unsigned threadCount)
+{
+    ASSERT(threadCount >= 1);
+
+    for (unsigned i = 1; i < threadCount; ++i)
+        workers.emplace_back(&ThreadPool::work, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        isStopping = true;
+    }
+
+    workAvailable.notify_all();
+
+    for (auto& worker : workers)
+        worker.join();
+}
+
+void ThreadPool::forEach(size_t count, const std::function<void(size_t)>& task)
+{
+    if (count == 0)
+        return;
+
+    if (workers.empty() || count == 1)
+    {
+        for (size_t i = 0; i < count; ++i)
+            task(i);
+
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    currentTask = &task;
+    taskCount = count;
+    nextTaskIndex = 0;
+    unfinishedTaskCount = count;
+    exception = nullptr;
+    workAvailable.notify_all();
+
+    runTasks(lock);
+    workFinished.wait(lock, [&] { return unfinishedTaskCount == 0; });
+    currentTask = nullptr;
+
+    if (exception)
+        std::rethrow_exception(std::exchange(exception, nullptr));
+}
+
+void ThreadPool::work()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (true)
+    {
+        workAvailable.wait(lock, [&] { return isStopping || nextTaskIndex < taskCount; });
+
+        if (isStopping)
+            return;
+
+        runTasks(lock);
+    }
+}
+
+void ThreadPool::runTasks(std::unique_lock<std::mutex>& lock)
+{
+    while (nextTaskIndex < taskCount)
+    {
+        auto index = nextTaskIndex++;
+        auto& task = *currentTask;
+        lock.unlock();
+
+        try
+        {
+            task(index);
+        }
+        catch (...)
+        {
+            lock.lock();
+            if (!exception)
+                exception = std::current_exception();
+            lock.unlock();
+        }
+
+        lock.lock();
+
+        if (--unfinishedTaskCount == 0)
+            workFinished.notify_all();
+    }
+}
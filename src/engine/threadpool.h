@@ -0,0 +1,40 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// A fixed set of worker threads that execute batches of independent tasks.
+class ThreadPool
+{
+public:
+    /// Creates a pool that runs tasks on `threadCount` threads, including the calling thread. A pool with
+    /// a single thread runs every task on the calling thread.
+    explicit ThreadPool(unsigned threadCount = std::max(1u, std::thread::hardware_concurrency()));
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    /// Calls `task` with each index in [0, count) and returns once every call has finished. The calls may
+    /// run concurrently and in any order. If a call throws, the exception is rethrown on the calling thread.
+    void forEach(size_t count, const std::function<void(size_t)>& task);
+    unsigned getThreadCount() const { return unsigned(workers.size()) + 1; }
+
+private:
+    void work();
+    void runTasks(std::unique_lock<std::mutex>& lock);
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable workAvailable;
+    std::condition_variable workFinished;
+    const std::function<void(size_t)>* currentTask = nullptr;
+    size_t taskCount = 0;
+    size_t nextTaskIndex = 0;
+    size_t unfinishedTaskCount = 0;
+    std::exception_ptr exception;
+    bool isStopping = false;
+};
@@ -123,7 +123,12 @@ Event Window::pollEvent()
     SDL_Event event;
 
     if (SDL_PollEvent(&event))
+    {
+        if (event.type == SDL_MOUSEMOTION)
+            stateManager->onMouseMove();
+
         return convertEvent(event);
+    }
 
     return Event();
 }
@@ -132,11 +137,28 @@ Event Window::waitForInput()
 {
     while (true)
     {
-        if (auto event = pollEvent())
-            return event;
+        stateManager->markChangedRegions();
+
+        if (context.isFrameDue())
+        {
+            context.beginFrame();
+            stateManager->render();
+            context.updateScreen();
+        }
 
-        stateManager->render();
-        context.updateScreen();
+        SDL_Event event;
+        int timeout = context.getTimeUntilNextFrame();
+
+        if (timeout < 0 ? SDL_WaitEvent(&event) : SDL_WaitEventTimeout(&event, timeout))
+        {
+            // Only the cursor depends on the mouse position. Other changes are marked by the states
+            // handling the input.
+            if (event.type == SDL_MOUSEMOTION)
+                stateManager->onMouseMove();
+
+            if (auto convertedEvent = convertEvent(event))
+                return convertedEvent;
+        }
     }
 }
 
@@ -147,6 +169,11 @@ bool Window::handleWindowEvent(int eventType)
         case SDL_WINDOWEVENT_CLOSE:
             sendCloseRequest();
             break;
+        case SDL_WINDOWEVENT_EXPOSED:
+        case SDL_WINDOWEVENT_SIZE_CHANGED:
+            // The previous contents of the window may be lost.
+            context.invalidate();
+            return false;
         default:
             return false;
     }
@@ -33,6 +33,8 @@ public:
     ~Window();
     Event convertEvent(const SDL_Event& event);
     Event pollEvent();
+    /// Renders frames as they become due while waiting for an input event. Blocks without
+    /// rendering while nothing on the screen changes.
     Event waitForInput();
     Vector2 getMousePosition() const;
     void setFullscreen(bool enable);
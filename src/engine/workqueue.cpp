@@ -0,0 +1,53 @@
+#include "workqueue.h"
+#include "assert.h"
+
+WorkQueue::WorkQueue(unsigned threadCount)
+{
+    ASSERT(threadCount >= 1);
+
+    for (unsigned i = 0; i < threadCount; ++i)
+        workers.emplace_back(&WorkQueue::work, this);
+}
+
+WorkQueue::~WorkQueue()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        isStopping = true;
+        tasks.clear();
+    }
+
+    workAvailable.notify_all();
+
+    for (auto& worker : workers)
+        worker.join();
+}
+
+void WorkQueue::push(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+
+    workAvailable.notify_one();
+}
+
+void WorkQueue::work()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (true)
+    {
+        workAvailable.wait(lock, [&] { return isStopping || !tasks.empty(); });
+
+        if (isStopping)
+            return;
+
+        auto task = std::move(tasks.front());
+        tasks.pop_front();
+        lock.unlock();
+        task();
+        lock.lock();
+    }
+}
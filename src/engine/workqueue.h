@@ -0,0 +1,40 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// Runs tasks in the background on a fixed set of worker threads, in the order they were submitted.
+class WorkQueue
+{
+public:
+    explicit WorkQueue(unsigned threadCount);
+    /// Waits for the running tasks to finish. Tasks that haven't started are discarded.
+    ~WorkQueue();
+    WorkQueue(const WorkQueue&) = delete;
+    WorkQueue& operator=(const WorkQueue&) = delete;
+
+    template<typename Function>
+    auto submit(Function function) -> std::future<decltype(function())>
+    {
+        auto task = std::make_shared<std::packaged_task<decltype(function())()>>(std::move(function));
+        auto future = task->get_future();
+        push([task] { (*task)(); });
+        return future;
+    }
+
+private:
+    void push(std::function<void()> task);
+    void work();
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable workAvailable;
+    bool isStopping = false;
+};
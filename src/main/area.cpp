@@ -6,7 +6,7 @@
 const Vector2 Area::sizeVector = Vector2(Area::size, Area::size);
 
 Area::Area(World& world, Vector2 position, int level)
-:   world(world), position(position)
+:   layers(std::make_unique<TileLayers>(world, level, size * size)), world(world), position(position), level(level)
 {
     tiles.reserve(size * size);
     std::string_view groundId = level < 0 ? "DirtFloor" : "Grass";
@@ -15,7 +15,7 @@ Area::Area(World& world, Vector2 position, int level)
     {
         for (pos.x = 0; pos.x < size; ++pos.x)
         {
-            tiles.emplace_back(world, position * sizeVector + pos, level, groundId);
+            tiles.emplace_back(*layers, int(tiles.size()), position * sizeVector + pos, groundId);
 
             if (level < 0)
                 tiles.back().setObject(std::make_unique<Object>("Ground"));
@@ -24,19 +24,22 @@ Area::Area(World& world, Vector2 position, int level)
 }
 
 Area::Area(const SaveFile& file, World& world, Vector2 position, int level)
-:   world(world), position(position)
+:   layers(std::make_unique<TileLayers>(world, level, size * size)), world(world), position(position), level(level)
 {
+    lastSimulatedStep = file.readUint64();
     tiles.reserve(size * size);
 
     for (Vector2 pos(0, 0); pos.y < size; ++pos.y)
     {
         for (pos.x = 0; pos.x < size; ++pos.x)
-            tiles.emplace_back(file, world, position * sizeVector + pos, level);
+            tiles.emplace_back(file, *layers, int(tiles.size()), position * sizeVector + pos);
     }
 }
 
 void Area::save(SaveFile& file) const
 {
+    file.writeInt64(lastSimulatedStep);
+
     for (auto& tile : tiles)
         tile.save(file);
 }
@@ -1,9 +1,13 @@
 #pragma once
 
+#include "lighting.h"
 #include "tile.h"
 #include "engine/geometry.h"
+#include <memory>
+#include <unordered_map>
 #include <vector>
 
+class Creature;
 class SaveFile;
 class Tile;
 class Window;
@@ -16,11 +20,23 @@ public:
     Area(const SaveFile& file, World& world, Vector2 position, int level);
     void save(SaveFile& file) const;
     Tile& getTileAt(Vector2 position);
+    Rect getRegion() const { return Rect(position * sizeVector, sizeVector); }
 
     static const int size = 64;
     static const Vector2 sizeVector;
 
+    /// Allocated separately, so that the tiles can refer to it even when the area is moved.
+    std::unique_ptr<TileLayers> layers;
     std::vector<Tile> tiles;
+    std::unordered_map<Vector2, LightEmitter> lightEmitters;
+    /// Creatures standing on the tiles of this area, for fast spatial queries.
+    std::vector<Creature*> creatures;
     World& world;
     Vector2 position;
+    int level;
+    uint64_t sightVersion = 0;
+    /// Used by World to evict the least recently used areas.
+    uint64_t lastUsed = 0;
+    /// The World::exist call in which the creatures of this area were last updated.
+    uint64_t lastSimulatedStep = 0;
 };
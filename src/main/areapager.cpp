@@ -0,0 +1,252 @@
+#include "areapager.h"
+#include "engine/assert.h"
+#include <algorithm>
+#include <stdexcept>
+
+AreaPager::AreaPager()
+:   file(std::tmpfile(), std::fclose)
+{
+    if (!file)
+        throw std::runtime_error("Unable to create area swap file");
+
+    worker = std::thread(&AreaPager::work, this);
+}
+
+AreaPager::~AreaPager()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        isStopping = true;
+    }
+
+    workAvailable.notify_all();
+    worker.join();
+}
+
+bool AreaPager::contains(Vector3 areaPosition) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.find(areaPosition) != entries.end();
+}
+
+std::vector<Vector3> AreaPager::getAreaPositions() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<Vector3> areaPositions;
+    areaPositions.reserve(entries.size());
+
+    for (auto& positionAndEntry : entries)
+        areaPositions.push_back(positionAndEntry.first);
+
+    return areaPositions;
+}
+
+void AreaPager::store(Vector3 areaPosition, std::vector<char> data)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ASSERT(entries.find(areaPosition) == entries.end());
+
+        auto slot = std::find_if(freeSlots.begin(), freeSlots.end(), [&](const Entry& entry)
+        {
+            return entry.capacity >= data.size();
+        });
+
+        Entry entry;
+
+        if (slot != freeSlots.end())
+        {
+            entry = *slot;
+            freeSlots.erase(slot);
+        }
+        else
+        {
+            entry = { fileSize, 0, data.size() };
+            fileSize += int64_t(data.size());
+        }
+
+        entry.size = data.size();
+        entries.emplace(areaPosition, entry);
+        pendingWrites[areaPosition] = std::make_shared<const std::vector<char>>(std::move(data));
+        writeQueue.push_back(areaPosition);
+    }
+
+    workAvailable.notify_one();
+}
+
+std::vector<char> AreaPager::take(Vector3 areaPosition)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    auto it = entries.find(areaPosition);
+    ASSERT(it != entries.end());
+    auto entry = it->second;
+    entries.erase(it);
+    std::vector<char> data;
+
+    auto pendingWrite = pendingWrites.find(areaPosition);
+    auto prefetchedArea = prefetchedAreas.find(areaPosition);
+
+    if (pendingWrite != pendingWrites.end())
+    {
+        data = *pendingWrite->second;
+        pendingWrites.erase(pendingWrite);
+    }
+    else if (prefetchedArea != prefetchedAreas.end())
+    {
+        data = std::move(prefetchedArea->second);
+        prefetchedAreas.erase(prefetchedArea);
+    }
+    else
+    {
+        lock.unlock();
+        bool didRead = readFromFile(entry, data);
+        lock.lock();
+
+        if (!didRead)
+        {
+            entries.emplace(areaPosition, entry);
+            throw std::runtime_error("Unable to read from area swap file");
+        }
+    }
+
+    freeSlot(entry);
+    return data;
+}
+
+std::vector<char> AreaPager::read(Vector3 areaPosition) const
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    auto it = entries.find(areaPosition);
+    ASSERT(it != entries.end());
+
+    auto pendingWrite = pendingWrites.find(areaPosition);
+    if (pendingWrite != pendingWrites.end())
+        return *pendingWrite->second;
+
+    auto prefetchedArea = prefetchedAreas.find(areaPosition);
+    if (prefetchedArea != prefetchedAreas.end())
+        return prefetchedArea->second;
+
+    auto entry = it->second;
+    lock.unlock();
+    std::vector<char> data;
+
+    if (!readFromFile(entry, data))
+        throw std::runtime_error("Unable to read from area swap file");
+
+    return data;
+}
+
+void AreaPager::prefetch(const std::vector<Vector3>& areaPositions)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        prefetchQueue.clear();
+
+        for (auto it = prefetchedAreas.begin(); it != prefetchedAreas.end();)
+        {
+            if (std::find(areaPositions.begin(), areaPositions.end(), it->first) == areaPositions.end())
+                it = prefetchedAreas.erase(it);
+            else
+                ++it;
+        }
+
+        for (auto areaPosition : areaPositions)
+        {
+            if (entries.find(areaPosition) != entries.end()
+                && prefetchedAreas.find(areaPosition) == prefetchedAreas.end()
+                && pendingWrites.find(areaPosition) == pendingWrites.end())
+                prefetchQueue.push_back(areaPosition);
+        }
+    }
+
+    workAvailable.notify_one();
+}
+
+void AreaPager::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::lock_guard<std::mutex> fileLock(fileMutex);
+    entries.clear();
+    freeSlots.clear();
+    pendingWrites.clear();
+    prefetchedAreas.clear();
+    writeQueue.clear();
+    prefetchQueue.clear();
+    fileSize = 0;
+}
+
+void AreaPager::work()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (true)
+    {
+        workAvailable.wait(lock, [&] { return isStopping || !writeQueue.empty() || !prefetchQueue.empty(); });
+
+        if (isStopping)
+            return;
+
+        if (!writeQueue.empty())
+        {
+            auto areaPosition = writeQueue.front();
+            writeQueue.pop_front();
+
+            auto pendingWrite = pendingWrites.find(areaPosition);
+            if (pendingWrite == pendingWrites.end())
+                continue;
+
+            auto data = pendingWrite->second;
+            auto offset = entries.at(areaPosition).offset;
+            lock.unlock();
+            bool didWrite = writeToFile(offset, *data);
+            lock.lock();
+
+            // If the write failed, the data is kept in memory. The area may also have been taken and
+            // stored again while it was being written.
+            pendingWrite = pendingWrites.find(areaPosition);
+            if (didWrite && pendingWrite != pendingWrites.end() && pendingWrite->second == data)
+                pendingWrites.erase(pendingWrite);
+        }
+        else
+        {
+            auto areaPosition = prefetchQueue.front();
+            prefetchQueue.pop_front();
+
+            auto it = entries.find(areaPosition);
+            if (it == entries.end() || pendingWrites.count(areaPosition) || prefetchedAreas.count(areaPosition))
+                continue;
+
+            auto entry = it->second;
+            std::vector<char> data;
+            lock.unlock();
+            bool didRead = readFromFile(entry, data);
+            lock.lock();
+
+            it = entries.find(areaPosition);
+            if (didRead && it != entries.end() && it->second.offset == entry.offset && !pendingWrites.count(areaPosition))
+                prefetchedAreas.emplace(areaPosition, std::move(data));
+        }
+    }
+}
+
+bool AreaPager::writeToFile(int64_t offset, const std::vector<char>& data) const
+{
+    std::lock_guard<std::mutex> lock(fileMutex);
+    return std::fseek(file.get(), long(offset), SEEK_SET) == 0
+        && std::fwrite(data.data(), 1, data.size(), file.get()) == data.size();
+}
+
+bool AreaPager::readFromFile(Entry entry, std::vector<char>& data) const
+{
+    std::lock_guard<std::mutex> lock(fileMutex);
+    data.resize(entry.size);
+    return std::fseek(file.get(), long(entry.offset), SEEK_SET) == 0
+        && std::fread(data.data(), 1, data.size(), file.get()) == data.size();
+}
+
+void AreaPager::freeSlot(Entry entry)
+{
+    entry.size = 0;
+    freeSlots.push_back(entry);
+}
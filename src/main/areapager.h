@@ -0,0 +1,61 @@
+#pragma once
+
+#include "engine/geometry.h"
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/// Stores the serialized data of areas that are not resident in memory in a temporary swap file.
+/// Writes to the swap file happen on a background thread, which also reads areas ahead of time
+/// when they are expected to be needed soon.
+class AreaPager
+{
+public:
+    AreaPager();
+    ~AreaPager();
+    AreaPager(const AreaPager&) = delete;
+    AreaPager& operator=(const AreaPager&) = delete;
+    bool contains(Vector3 areaPosition) const;
+    std::vector<Vector3> getAreaPositions() const;
+    void store(Vector3 areaPosition, std::vector<char> data);
+    /// Returns the stored data of the given area and removes it from the pager.
+    std::vector<char> take(Vector3 areaPosition);
+    /// Returns the stored data of the given area without removing it.
+    std::vector<char> read(Vector3 areaPosition) const;
+    /// Starts reading the given areas in the background, replacing any previous prefetch requests.
+    void prefetch(const std::vector<Vector3>& areaPositions);
+    void clear();
+
+private:
+    struct Entry
+    {
+        int64_t offset;
+        size_t size;
+        size_t capacity;
+    };
+
+    void work();
+    bool writeToFile(int64_t offset, const std::vector<char>& data) const;
+    bool readFromFile(Entry entry, std::vector<char>& data) const;
+    void freeSlot(Entry entry);
+
+    std::unique_ptr<FILE, int (&)(FILE*)> file;
+    int64_t fileSize = 0;
+    std::unordered_map<Vector3, Entry> entries;
+    std::vector<Entry> freeSlots;
+    std::unordered_map<Vector3, std::shared_ptr<const std::vector<char>>> pendingWrites;
+    std::unordered_map<Vector3, std::vector<char>> prefetchedAreas;
+    std::deque<Vector3> writeQueue;
+    std::deque<Vector3> prefetchQueue;
+    mutable std::mutex mutex;
+    /// Serializes access to the swap file.
+    mutable std::mutex fileMutex;
+    std::condition_variable workAvailable;
+    bool isStopping = false;
+    std::thread worker;
+};
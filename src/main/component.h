@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <string_view>
 #include <memory>
 
@@ -9,10 +10,20 @@ class Game;
 class Item;
 class SaveFile;
 
+/// Identifies the concrete type of a component. Each component class declares its id as `staticId`.
+enum class ComponentId : uint8_t
+{
+    Dig,
+    Door,
+    LightSource
+};
+
 class Component
 {
 public:
+    explicit Component(ComponentId id) : id(id) {}
     virtual ~Component() = 0;
+    ComponentId getId() const { return id; }
     static std::unique_ptr<Component> get(std::string_view name, Entity& parent);
 
     /// Returns true if the component did react to the movement attempt.
@@ -26,4 +37,7 @@ public:
     virtual void load(const SaveFile& file) = 0;
 
     Entity* parent;
+
+private:
+    ComponentId id;
 };
@@ -4,6 +4,12 @@
 
 class Dig : public Component
 {
+public:
+    Dig() : Component(staticId) {}
+
+    static const ComponentId staticId = ComponentId::Dig;
+
+private:
     bool isUsable() const override { return true; }
     bool use(Creature& digger, Item& digItem, Game& game) override;
     void save(SaveFile&) const override {}
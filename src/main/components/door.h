@@ -4,6 +4,12 @@
 
 class Door : public Component
 {
+public:
+    Door() : Component(staticId) {}
+
+    static const ComponentId staticId = ComponentId::Door;
+
+private:
     bool reactToMovementAttempt() override;
     bool preventsMovement() override { return !isOpen; }
     bool close() override;
@@ -3,11 +3,11 @@
 #include "controller.h"
 #include "game.h"
 #include "msgsystem.h"
+#include "pathfinding.h"
 #include "tile.h"
 #include "engine/assert.h"
 #include "engine/config.h"
 #include "engine/math.h"
-#include "engine/raycast.h"
 #include "engine/savefile.h"
 #include <cctype>
 #include <climits>
@@ -93,10 +93,7 @@ Creature::Creature(Tile* tile, const SaveFile& file)
     for (auto& component : getComponents())
         component->load(file);
 
-    auto seenTilePositionsCount = file.readInt32();
-    seenTilePositions.reserve(size_t(seenTilePositionsCount));
-    for (int i = 0; i < seenTilePositionsCount; ++i)
-        seenTilePositions.insert(file.readVector3());
+    seenTiles = TileMemory(file);
 
     auto inventorySize = file.readInt32();
     inventory.reserve(size_t(inventorySize));
@@ -126,9 +123,7 @@ void Creature::save(SaveFile& file) const
     for (auto& component : getComponents())
         component->save(file);
 
-    file.writeInt32(uint32_t(seenTilePositions.size()));
-    for (auto tilePosition : seenTilePositions)
-        file.write(tilePosition);
+    seenTiles.save(file);
 
     file.write(inventory);
 
@@ -162,6 +157,13 @@ void Creature::exist()
     }
 }
 
+void Creature::catchUp(int turns)
+{
+    // Regeneration only adds up to the maximum, so doing it all at once gives the same result.
+    editHP(0.1 * turns);
+    editMP(0.1 * turns);
+}
+
 void Creature::regenerate()
 {
     editHP(0.1);
@@ -210,6 +212,7 @@ void Creature::calculateDerivedStats()
 
     currentHP = hpRatio * maxHP;
     currentMP = mpRatio * maxMP;
+    ++statsVersion;
 }
 
 double Creature::getAttribute(Attribute attribute) const
@@ -226,12 +229,16 @@ void Creature::setAttribute(Attribute attribute, double amount)
 {
     for (auto index : getAttributeIndices(attribute))
         attributeValues[index] = amount;
+
+    ++statsVersion;
 }
 
 void Creature::editAttribute(Attribute attribute, double amount)
 {
     for (auto index : getAttributeIndices(attribute))
         attributeValues[index] += amount;
+
+    ++statsVersion;
 }
 
 int Creature::getFieldOfVisionRadius() const
@@ -239,61 +246,46 @@ int Creature::getFieldOfVisionRadius() const
     return int(getAttribute(Perception) * 2);
 }
 
-static bool sightHandler(Vector2 vector, const Tile* tile)
+void Creature::updateFieldOfVision() const
 {
-    auto* currentTile = tile->getWorld().getTile(vector, tile->getLevel());
+    auto radius = getFieldOfVisionRadius();
 
-    if (!currentTile)
-        return false;
+    if (fieldOfVision.isUpToDate(getWorld(), getPosition(), getLevel(), radius))
+        return;
 
-    if (currentTile != tile && currentTile->blocksSight())
-        return false;
+    fieldOfVision.update(getWorld(), getPosition(), getLevel(), radius);
 
-    if (currentTile->getLight().getLuminance() < 0.3)
-        return false;
+    for (auto position : fieldOfVision.getVisiblePositions())
+        seenTiles.add(Vector3(position) + Vector3(0, 0, getLevel()));
+}
 
-    return true;
+const FieldOfVision& Creature::getFieldOfVision() const
+{
+    updateFieldOfVision();
+    return fieldOfVision;
 }
 
 bool Creature::sees(const Tile& tile) const
 {
     ASSERT(tile.getLevel() == getLevel());
-
-    if (getDistance(getPosition(), tile.getPosition()) > getFieldOfVisionRadius())
-        return false;
-
-    bool sees = raycast(getPosition(), tile.getPosition(), sightHandler, &tile);
-
-    if (sees)
-        seenTilePositions.emplace(tile.getPosition3D());
-
-    return sees;
+    updateFieldOfVision();
+    return fieldOfVision.isVisible(tile.getPosition());
 }
 
 bool Creature::remembers(const Tile& tile) const
 {
-    return seenTilePositions.find(tile.getPosition3D()) != seenTilePositions.end();
+    return seenTiles.contains(tile.getPosition3D());
 }
 
 std::vector<Creature*> Creature::getCreaturesCurrentlySeenBy(int maxFieldOfVisionRadius) const
 {
     std::vector<Creature*> creatures;
+    auto radius = Vector2(maxFieldOfVisionRadius, maxFieldOfVisionRadius);
 
-    for (int x = -maxFieldOfVisionRadius; x <= maxFieldOfVisionRadius; ++x)
+    for (auto* creature : getWorld().getCreatures(Rect(getPosition() - radius, radius * 2 + Vector2(1, 1)), getLevel()))
     {
-        for (int y = -maxFieldOfVisionRadius; y <= maxFieldOfVisionRadius; ++y)
-        {
-            auto* tile = getWorld().getTile(getPosition() + Vector2(x, y), getLevel());
-
-            if (!tile)
-                continue;
-
-            if (auto creature = tile->getCreature())
-            {
-                if (creature != this && creature->sees(getTileUnder(0)))
-                    creatures.push_back(creature);
-            }
-        }
+        if (creature != this && creature->sees(getTileUnder(0)))
+            creatures.push_back(creature);
     }
 
     return creatures;
@@ -302,23 +294,12 @@ std::vector<Creature*> Creature::getCreaturesCurrentlySeenBy(int maxFieldOfVisio
 std::vector<Creature*> Creature::getCurrentlySeenCreatures() const
 {
     std::vector<Creature*> currentlySeenCreatures;
-    auto fieldOfVisionRadius = getFieldOfVisionRadius();
+    auto radius = Vector2(getFieldOfVisionRadius(), getFieldOfVisionRadius());
 
-    for (int x = -fieldOfVisionRadius; x <= fieldOfVisionRadius; ++x)
+    for (auto* creature : getWorld().getCreatures(Rect(getPosition() - radius, radius * 2 + Vector2(1, 1)), getLevel()))
     {
-        for (int y = -fieldOfVisionRadius; y <= fieldOfVisionRadius; ++y)
-        {
-            auto* tile = getWorld().getTile(getPosition() + Vector2(x, y), getLevel());
-
-            if (!tile || !sees(*tile))
-                continue;
-
-            if (auto creature = tile->getCreature())
-            {
-                if (creature != this)
-                    currentlySeenCreatures.push_back(creature);
-            }
-        }
+        if (creature != this && sees(creature->getTileUnder(0)))
+            currentlySeenCreatures.push_back(creature);
     }
 
     return currentlySeenCreatures;
@@ -366,6 +347,9 @@ Action Creature::tryToMoveOrAttack(Dir8 direction)
         bool preventsMovement = destination->getObject()->preventsMovement();
         bool didReactToMovementAttempt = destination->getObject()->reactToMovementAttempt();
 
+        if (didReactToMovementAttempt)
+            destination->onObjectChanged();
+
         if (preventsMovement)
             return didReactToMovementAttempt ? Wait : NoAction;
     }
@@ -377,7 +361,25 @@ Action Creature::tryToMoveOrAttack(Dir8 direction)
 Action Creature::tryToMoveTowardsOrAttack(Creature& target)
 {
     auto directionVector = target.getPosition() - getPosition();
-    return tryToMoveOrAttack(directionVector.getDir8());
+
+    if (auto action = tryToMoveOrAttack(directionVector.getDir8()))
+        return action;
+
+    // The direct route is blocked, so find a way around the obstacle.
+    thread_local PathFinder pathFinder;
+    auto& targetTile = target.getTileUnder(0);
+    auto path = pathFinder.findPath(getTileUnder(0), targetTile, [&](Tile& tile)
+    {
+        if (&tile == &targetTile)
+            return true;
+
+        return !tile.hasCreature() && (!tile.hasObject() || !tile.getObject()->preventsMovement());
+    }, true);
+
+    if (path.size() < 2)
+        return NoAction;
+
+    return tryToMoveOrAttack((path[1]->getPosition() - getPosition()).getDir8());
 }
 
 void Creature::moveTo(Tile& destination)
@@ -475,6 +477,7 @@ void Creature::takeDamage(double amount)
     if (amount > 0)
     {
         currentHP -= amount;
+        ++statsVersion;
 
         if (isDead())
             onDeath();
@@ -527,6 +530,14 @@ bool Creature::pickUpItem()
 void Creature::equip(EquipmentSlot slot, Item* item)
 {
     equipment[slot] = item;
+    ++statsVersion;
+
+    if (!tilesUnder.empty())
+        getWorld().invalidateLightSources(getPosition(), getLevel());
+
+    // The equipment is drawn on top of the creature.
+    for (auto* tile : tilesUnder)
+        tile->markChanged();
 }
 
 bool Creature::use(Item& itemToUse, Game& game)
@@ -577,7 +588,12 @@ int Creature::getInventoryIndex(const Item& item) const
 bool Creature::close(Dir8 direction)
 {
     Tile* destination = getTileUnder(0).getAdjacentTile(direction);
-    return destination && destination->hasObject() && destination->getObject()->close();
+
+    if (!destination || !destination->hasObject() || !destination->getObject()->close())
+        return false;
+
+    destination->onObjectChanged();
+    return true;
 }
 
 Vector2 Creature::getPosition() const
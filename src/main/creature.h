@@ -2,11 +2,12 @@
 
 #include "controller.h"
 #include "entity.h"
+#include "fieldofvision.h"
 #include "msgsystem.h"
+#include "tilememory.h"
 #include "engine/geometry.h"
 #include "engine/sprite.h"
 #include "engine/utility.h"
-#include <unordered_set>
 #include <cctype>
 #include <memory>
 #include <sstream>
@@ -81,6 +82,9 @@ public:
     Creature(Tile* tile, const SaveFile& file);
     void save(SaveFile& file) const;
     void exist();
+    /// Applies the regeneration of turns spent in an area that wasn't simulated. Bleeding is skipped,
+    /// as the blood would have dried up by the time anyone could see it.
+    void catchUp(int turns);
     void render(Window& window, Vector2 position) const;
 
     Action tryToMoveOrAttack(Dir8);
@@ -105,7 +109,7 @@ public:
     Item* getEquipment(EquipmentSlot slot) const { return equipment[slot]; }
     int getInventoryIndex(const Item& item) const;
     bool isRunning() const { return running; }
-    void setRunning(bool running) { this->running = running; }
+    void setRunning(bool running) { this->running = running; ++statsVersion; }
     bool isDead() const { return currentHP <= 0; }
     double getHP() const { return currentHP; }
     double getAP() const { return currentAP; }
@@ -118,6 +122,11 @@ public:
     template<typename... Args>
     void addMessage(Args&&...);
     const std::vector<Message>& getMessages() const { return messages; }
+    /// Changes whenever the HP, MP, attributes, running state or equipment of the creature change.
+    uint64_t getStatsVersion() const { return statsVersion; }
+    /// Changes whenever a message is added.
+    uint64_t getMessagesVersion() const { return messagesVersion; }
+    const FieldOfVision& getFieldOfVision() const;
     bool sees(const Tile& tile) const;
     bool remembers(const Tile& tile) const;
     std::vector<Creature*> getCreaturesCurrentlySeenBy(int maxFieldOfVisionRadius) const;
@@ -135,17 +144,19 @@ private:
     void editAttribute(Attribute, double amount);
     void generateAttributes(std::string_view);
     void calculateDerivedStats();
-    void editHP(double amount) { currentHP = std::min(currentHP + amount, maxHP); }
+    void editHP(double amount) { currentHP = std::min(currentHP + amount, maxHP); ++statsVersion; }
     void editAP(double amount) { currentAP += amount; }
-    void editMP(double amount) { currentMP = std::min(currentMP + amount, maxMP); }
+    void editMP(double amount) { currentMP = std::min(currentMP + amount, maxMP); ++statsVersion; }
     void regenerate();
     void onDeath();
+    void updateFieldOfVision() const;
     static std::vector<Attribute> initDisplayedAttributes(std::string_view);
     static std::vector<std::vector<int>> initAttributeIndices(std::string_view);
     const auto& getAttributeIndices(int attribute) const { return attributeIndices[attribute]; }
 
     std::vector<Tile*> tilesUnder;
-    mutable std::unordered_set<Vector3> seenTilePositions;
+    mutable TileMemory seenTiles;
+    mutable FieldOfVision fieldOfVision;
     std::vector<std::unique_ptr<Item>> inventory;
     Item* equipment[equipmentSlots];
     double currentHP, maxHP, currentAP, currentMP, maxMP;
@@ -156,6 +167,8 @@ private:
     Sprite sprite;
     std::unique_ptr<Controller> controller;
     std::vector<Message> messages;
+    uint64_t statsVersion = 0;
+    uint64_t messagesVersion = 0;
 
     static constexpr double fullAP = 1.0;
     static const int configAttributes[8];
@@ -174,6 +187,8 @@ void Creature::addMessage(Args&&... messageParts)
         messages.back().increaseCount(getTurn());
     else
         messages.emplace_back(std::move(message), getTurn());
+
+    ++messagesVersion;
 }
 
 Attribute stringToAttribute(std::string_view);
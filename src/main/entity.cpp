@@ -1,18 +1,21 @@
 #include "entity.h"
-#include "engine/config.h"
 #include "engine/error.h"
 #include "engine/utility.h"
 
 Entity::Entity(std::string_view id, const Config& config)
 :   id(id),
-    config(&config)
+    config(&config),
+    typeHandle(config.getTypeHandle(id))
 {
     if (auto componentNames = config.getOptional<std::vector<std::string>>(id, "components"))
     {
         for (auto& componentName : *componentNames)
         {
             if (auto component = Component::get(componentName, *this))
+            {
+                componentMask |= getComponentBit(component->getId());
                 components.push_back(std::move(component));
+            }
             else
                 warn("Unknown component '" + componentName + "'");
         }
@@ -63,5 +66,6 @@ bool Entity::preventsMovement() const
         if (component->preventsMovement())
             return true;
 
-    return config->get<bool>(id, "preventsMovement");
+    static const auto preventsMovementAttribute = Config::getAttributeHandle("preventsMovement");
+    return config->get<bool>(typeHandle, preventsMovementAttribute);
 }
@@ -1,13 +1,12 @@
 #pragma once
 
 #include "component.h"
+#include "engine/config.h"
 #include <string_view>
 #include <memory>
 #include <string>
 #include <vector>
 
-class Config;
-
 class Entity
 {
 public:
@@ -19,8 +18,12 @@ public:
     std::string getNameIndefinite() const;
     std::string_view getId() const { return id; }
     const Config& getConfig() const { return *config; }
+    Config::TypeHandle getTypeHandle() const { return typeHandle; }
     template<typename ComponentType>
-    std::vector<ComponentType*> getComponentsOfType() const;
+    bool hasComponentOfType() const { return componentMask & getComponentBit(ComponentType::staticId); }
+    /// Calls `function` with each component of the given type, without allocating.
+    template<typename ComponentType, typename Function>
+    void forEachComponentOfType(Function function) const;
 
     /// Returns true if the entity reacted to the movement attempt.
     bool reactToMovementAttempt();
@@ -31,20 +34,23 @@ protected:
 
 private:
     virtual std::string getNameAdjective() const { return ""; }
+    static uint32_t getComponentBit(ComponentId id) { return 1u << unsigned(id); }
 
     std::string id;
     const Config* config;
+    Config::TypeHandle typeHandle;
     std::vector<std::unique_ptr<Component>> components;
+    /// Has a bit set for each type of component the entity has.
+    uint32_t componentMask = 0;
 };
 
-template<typename ComponentType>
-std::vector<ComponentType*> Entity::getComponentsOfType() const
+template<typename ComponentType, typename Function>
+void Entity::forEachComponentOfType(Function function) const
 {
-    std::vector<ComponentType*> componentsOfType;
+    if (!hasComponentOfType<ComponentType>())
+        return;
 
     for (auto& component : components)
-        if (auto* p = dynamic_cast<ComponentType*>(component.get()))
-            componentsOfType.push_back(p);
-
-    return componentsOfType;
+        if (component->getId() == ComponentType::staticId)
+            function(static_cast<ComponentType&>(*component));
 }
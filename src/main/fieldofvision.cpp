@@ -0,0 +1,88 @@
+#include "fieldofvision.h"
+#include "world.h"
+#include "engine/fov.h"
+
+bool FieldOfVision::isUpToDate(const World& world, Vector2 origin, int level, int radius)
+{
+    if (origin != this->origin || level != this->level || radius != this->radius)
+        return false;
+
+    if (world.getSightVersion() == worldSightVersion)
+        return true;
+
+    for (auto& [areaPosition, sightVersion] : areaSightVersions)
+    {
+        if (world.getSightVersion(areaPosition) != sightVersion)
+            return false;
+    }
+
+    worldSightVersion = world.getSightVersion();
+    return true;
+}
+
+void FieldOfVision::update(World& world, Vector2 origin, int level, int radius)
+{
+    this->origin = origin;
+    this->level = level;
+    this->radius = radius;
+    worldSightVersion = world.getSightVersion();
+
+    areaSightVersions.clear();
+    auto bounds = getBounds();
+    auto topLeft = world.globalPositionToAreaPosition(bounds.position, level);
+    auto bottomRight = world.globalPositionToAreaPosition(bounds.position + bounds.size - Vector2(1, 1), level);
+
+    for (int y = topLeft.y; y <= bottomRight.y; ++y)
+    {
+        for (int x = topLeft.x; x <= bottomRight.x; ++x)
+        {
+            Vector3 areaPosition(x, y, level);
+            areaSightVersions.emplace_back(areaPosition, world.getSightVersion(areaPosition));
+        }
+    }
+
+    visibility.assign(bounds.getArea(), false);
+    visiblePositions.clear();
+
+    auto sightMap = world.getSightMap(bounds, level);
+
+    auto isBlocking = [&](Vector2 position)
+    {
+        // Missing and dark tiles block sight as well.
+        return sightMap.getFlags(position) != 0;
+    };
+
+    auto setVisible = [&](Vector2 position)
+    {
+        auto index = (position.y - bounds.getTop()) * bounds.getWidth() + position.x - bounds.getLeft();
+
+        if (visibility[index])
+            return;
+
+        if (position != origin && (sightMap.isMissing(position) || sightMap.isDark(position)))
+            return;
+
+        visibility[index] = true;
+        visiblePositions.push_back(position);
+    };
+
+    computeFieldOfVision(origin, radius, isBlocking, setVisible);
+}
+
+bool FieldOfVision::isVisible(Vector2 position) const
+{
+    if (radius < 0)
+        return false;
+
+    auto bounds = getBounds();
+
+    if (!position.isWithin(bounds))
+        return false;
+
+    return visibility[(position.y - bounds.getTop()) * bounds.getWidth() + position.x - bounds.getLeft()];
+}
+
+Rect FieldOfVision::getBounds() const
+{
+    return Rect(origin - Vector2(radius, radius), Vector2(radius * 2 + 1, radius * 2 + 1));
+}
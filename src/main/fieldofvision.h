@@ -0,0 +1,30 @@
+#pragma once
+
+#include "engine/geometry.h"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+class World;
+
+/// Cached set of tiles visible from a position. The cache stays valid until the origin moves or the
+/// lighting or the sight-blocking state of an area within range changes.
+class FieldOfVision
+{
+public:
+    bool isUpToDate(const World& world, Vector2 origin, int level, int radius);
+    void update(World& world, Vector2 origin, int level, int radius);
+    bool isVisible(Vector2 position) const;
+    const std::vector<Vector2>& getVisiblePositions() const { return visiblePositions; }
+
+private:
+    Rect getBounds() const;
+
+    Vector2 origin;
+    int level = 0;
+    int radius = -1;
+    uint64_t worldSightVersion = 0;
+    std::vector<std::pair<Vector3, uint64_t>> areaSightVersions;
+    std::vector<bool> visibility;
+    std::vector<Vector2> visiblePositions;
+};
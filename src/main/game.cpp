@@ -3,13 +3,19 @@
 #include "item.h"
 #include "msgsystem.h"
 #include "tile.h"
+#include "engine/blending.h"
 #include "engine/config.h"
+#include "engine/filesystem.h"
 #include "engine/keyboard.h"
 #include "engine/math.h"
 #include "engine/menu.h"
 #include "engine/savefile.h"
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <cstring>
 #include <functional>
+#include <stdexcept>
 
 std::unique_ptr<Config> Game::creatureConfig;
 std::unique_ptr<Config> Game::objectConfig;
@@ -33,11 +39,7 @@ Game::Game(GameState* state)
     // TODO: Find a better place for loading assets, and make them non-static.
     if (!creatureConfig)
     {
-        creatureConfig = std::make_unique<Config>("data/config/creature.cfg");
-        objectConfig = std::make_unique<Config>("data/config/object.cfg");
-        itemConfig = std::make_unique<Config>("data/config/item.cfg");
-        groundConfig = std::make_unique<Config>("data/config/ground.cfg");
-        materialConfig = std::make_unique<Config>("data/config/material.cfg");
+        loadConfigs();
 
         creatureSpriteSheet = std::make_unique<Texture>("data/graphics/creature.bmp", transparentColor);
         objectSpriteSheet = std::make_unique<Texture>("data/graphics/object.bmp", transparentColor);
@@ -50,6 +52,21 @@ Game::Game(GameState* state)
     state->world.game = this;
 }
 
+static std::unique_ptr<Config> loadConfig(std::string_view name)
+{
+    auto filePath = "data/config/" + name + ".cfg";
+    return std::make_unique<Config>(filePath, filePath + ".bin");
+}
+
+void Game::loadConfigs()
+{
+    creatureConfig = loadConfig("creature");
+    objectConfig = loadConfig("object");
+    itemConfig = loadConfig("item");
+    groundConfig = loadConfig("ground");
+    materialConfig = loadConfig("material");
+}
+
 Window& Game::getWindow() const
 {
     return *window;
@@ -161,6 +178,8 @@ public:
 
 private:
     void render() override;
+    void markChangedRegions() override;
+    void onMouseMove() override;
 
     Game* game;
     Vector2 position;
@@ -196,6 +215,16 @@ StateChange LookMode::onKeyDown(Key key)
     return StateChange::None();
 }
 
+void LookMode::markChangedRegions()
+{
+    game->markChangedRegions(*window, position);
+}
+
+void LookMode::onMouseMove()
+{
+    game->markCursor(*window, position);
+}
+
 void LookMode::render()
 {
     game->renderAtPosition(*window, position);
@@ -299,15 +328,19 @@ void Game::render()
     renderAtPosition(*window, getPlayer()->getPosition());
 }
 
-void Game::renderAtPosition(Window& window, Vector2 centerPosition)
+Rect Game::setWorldView(Window& window, Vector2 centerPosition) const
 {
     Rect worldViewport = GUI::getWorldViewport(getWindow());
     Rect view(centerPosition * Tile::getSize() + Tile::getSize() / 2 - worldViewport.size / 2, worldViewport.size);
-    Rect visibleRegion(centerPosition - worldViewport.size / Tile::getSize() / 2, worldViewport.size / Tile::getSize());
 
     window.context.setView(&view);
     window.context.setViewport(&worldViewport);
+    return Rect(centerPosition - worldViewport.size / Tile::getSize() / 2, worldViewport.size / Tile::getSize());
+}
 
+void Game::renderAtPosition(Window& window, Vector2 centerPosition)
+{
+    Rect visibleRegion = setWorldView(window, centerPosition);
     auto cursorPosition = window.getMousePosition().divFloor(Tile::spriteSize);
     hoveredTile = cursorPosition.isWithin(visibleRegion) ? getWorld().getTile(cursorPosition, getPlayer()->getLevel()) : nullptr;
     getWorld().render(window, visibleRegion, getPlayer()->getLevel(), *getPlayer());
@@ -333,8 +366,136 @@ void Game::renderAtPosition(Window& window, Vector2 centerPosition)
     }
 }
 
+static void markTile(Window& window, Vector2 position)
+{
+    window.context.markDirty(Rect(position * Tile::getSize(), Tile::getSize()));
+}
+
+void Game::markChangedRegions()
+{
+    markChangedRegions(*window, getPlayer()->getPosition());
+}
+
+void Game::markChangedRegions(Window& window, Vector2 centerPosition)
+{
+    auto* player = getPlayer();
+    auto& world = getWorld();
+    auto center = Vector3(centerPosition) + Vector3(0, 0, player->getLevel());
+    bool isFirstCall = !markedCenter;
+    bool hasViewMoved = center != markedCenter || playerSeesEverything != markedSeesEverything;
+    bool hasTurnChanged = getTurn() != markedTurn;
+    bool hasStatsChanged = player->getStatsVersion() != markedStatsVersion;
+    Rect visibleRegion = setWorldView(window, centerPosition);
+
+    // Areas may finish generating in the background while the player is idle. Keep waking up to add
+    // them to the world until they're all done, so that they're drawn without waiting for input.
+    if (world.installGeneratedAreas())
+    {
+        int generationPollInterval = 50;
+        window.context.scheduleFrame(generationPollInterval);
+    }
+
+    // Apply the light changes of the last turn now, so that the relit tiles get marked too.
+    world.updateLight();
+    auto changedTiles = world.takeChangedTiles(visibleRegion, player->getLevel());
+    auto& fieldOfVision = player->getFieldOfVision();
+
+    if (hasViewMoved)
+        window.context.markDirty(Rect(visibleRegion.position * Tile::getSize(), visibleRegion.size * Tile::getSize()));
+    else
+    {
+        // Tiles that came into or went out of sight look different even if nothing on them changed.
+        if (world.getSightVersion() != markedSightVersion || hasStatsChanged)
+        {
+            for (auto position : fieldOfVision.getVisiblePositions())
+            {
+                if (!markedFieldOfVision.isVisible(position))
+                    changedTiles.push_back(position);
+            }
+
+            for (auto position : markedFieldOfVision.getVisiblePositions())
+            {
+                if (!fieldOfVision.isVisible(position))
+                    changedTiles.push_back(position);
+            }
+        }
+
+        for (auto position : changedTiles)
+            markTile(window, position);
+    }
+
+    // The sidebar shows the tooltip of the hovered tile.
+    auto cursorPosition = window.getMousePosition().divFloor(Tile::spriteSize);
+    bool hasHoveredTileChanged = std::find(changedTiles.begin(), changedTiles.end(), cursorPosition) != changedTiles.end();
+
+    window.context.setView(nullptr);
+    window.context.setViewport(nullptr);
+
+    bool hasSidebarChanged = isFirstCall || hasViewMoved || hasStatsChanged || hasHoveredTileChanged;
+#ifdef DEBUG
+    // The extra info includes the turn.
+    hasSidebarChanged = hasSidebarChanged || (showExtraInfo && hasTurnChanged);
+#endif
+
+    if (hasSidebarChanged)
+        window.context.markDirty(GUI::getSidebarArea(window));
+
+    // Messages are highlighted during the turn they're added and the next one.
+    auto& messages = player->getMessages();
+    if (isFirstCall || player->getMessagesVersion() != markedMessagesVersion
+        || (hasTurnChanged && !messages.empty() && messages.back().turn >= markedTurn - 1))
+        window.context.markDirty(GUI::getMessageArea(window));
+
+    markedCenter = center;
+    markedSeesEverything = playerSeesEverything;
+    markedFieldOfVision = fieldOfVision;
+    markedSightVersion = world.getSightVersion();
+    markedStatsVersion = player->getStatsVersion();
+    markedMessagesVersion = player->getMessagesVersion();
+    markedTurn = getTurn();
+
+    // The view may have moved under the cursor.
+    markCursor(window, centerPosition);
+}
+
+void Game::onMouseMove()
+{
+    markCursor(*window, getPlayer()->getPosition());
+}
+
+void Game::markCursor(Window& window, Vector2 centerPosition)
+{
+    Rect visibleRegion = setWorldView(window, centerPosition);
+    auto cursorPosition = window.getMousePosition().divFloor(Tile::spriteSize);
+    std::optional<Vector2> hoveredPosition;
+
+    if (cursorPosition.isWithin(visibleRegion))
+        hoveredPosition = cursorPosition;
+
+    bool hasCursorMoved = hoveredPosition != markedCursorPosition;
+
+    // Redraw the previous tile without the cursor, and the new one with it.
+    if (hasCursorMoved && markedCursorPosition)
+        markTile(window, *markedCursorPosition);
+
+    if (hasCursorMoved && hoveredPosition)
+        markTile(window, *hoveredPosition);
+
+    window.context.setView(nullptr);
+    window.context.setViewport(nullptr);
+
+    // The sidebar shows the tooltip of the hovered tile.
+    if (hasCursorMoved)
+        window.context.markDirty(GUI::getSidebarArea(window));
+
+    markedCursorPosition = hoveredPosition;
+}
+
 void Game::renderSidebar(BitmapFont& font) const
 {
+    if (!getWindow().context.isDirty(GUI::getSidebarArea(getWindow())))
+        return;
+
     auto* player = getPlayer();
 
     font.setArea(GUI::getSidebarArea(getWindow()));
@@ -407,6 +568,7 @@ void Game::enterCommandMode(Window& window)
             MessageSystem::addToCommandHistory(std::string(command));
             parseCommand(command);
             command.clear();
+            window.context.markDirty(GUI::getDebugMessageArea(window));
         }
 
         if (result == Esc || result == commandModeKey)
@@ -420,16 +582,72 @@ void Game::enterCommandMode(Window& window)
     }
 }
 
+/// Compares the vectorized LinearLight kernel against the scalar one on tile-sized blocks of pixels.
+static void benchmarkLightBlending()
+{
+    using Clock = std::chrono::steady_clock;
+    const int iterations = 100;
+    std::vector<uint32_t> pixels(size_t(Tile::spriteSize.getArea()));
+
+    for (size_t i = 0; i < pixels.size(); ++i)
+        pixels[i] = uint32_t(i * 0x9E3779B1) | 0xFF;
+
+    auto scalarPixels = pixels;
+    auto vectorPixels = pixels;
+    Clock::duration scalarTime(0), vectorTime(0);
+    bool isExact = true;
+
+    for (int light = 0; light < 0x100; ++light)
+    {
+        Color color(light, 0xFF - light, light / 2);
+
+        for (int i = 0; i < iterations; ++i)
+        {
+            std::copy(pixels.begin(), pixels.end(), scalarPixels.begin());
+            auto start = Clock::now();
+            blendLinearLightScalar(scalarPixels.data(), int(scalarPixels.size()), color);
+            scalarTime += Clock::now() - start;
+
+            std::copy(pixels.begin(), pixels.end(), vectorPixels.begin());
+            start = Clock::now();
+            blendLinearLight(vectorPixels.data(), int(vectorPixels.size()), color);
+            vectorTime += Clock::now() - start;
+        }
+
+        isExact &= std::memcmp(scalarPixels.data(), vectorPixels.data(), pixels.size() * sizeof(uint32_t)) == 0;
+    }
+
+    auto toMilliseconds = [](Clock::duration duration) { return std::to_string(std::chrono::duration<double, std::milli>(duration).count()); };
+    MessageSystem::addDebugMessage("LinearLight: scalar " + toMilliseconds(scalarTime) + " ms, vectorized "
+                                   + toMilliseconds(vectorTime) + " ms" + (isExact ? "" : ", results differ!"),
+                                   isExact ? Normal : Warning);
+}
+
 void Game::parseCommand(std::string_view command)
 {
     if (command == "respawn")
+    {
         *getPlayer() = Creature(&getPlayer()->getTileUnder(0), "Human", std::make_unique<PlayerController>(*this));
+        getPlayer()->getTileUnder(0).markChanged();
+        getWindow().context.markDirty(GUI::getSidebarArea(getWindow()));
+        getWindow().context.markDirty(GUI::getMessageArea(getWindow()));
+    }
     else if (command == "clear")
         MessageSystem::clearDebugMessageHistory();
     else if (command == "info")
+    {
         showExtraInfo = !showExtraInfo;
+        getWindow().context.markDirty(GUI::getSidebarArea(getWindow()));
+    }
+    else if (command == "parallel")
+    {
+        getWorld().isSimulationParallel = !getWorld().isSimulationParallel;
+        MessageSystem::addDebugMessage("Parallel simulation " + toOnOffString(getWorld().isSimulationParallel));
+    }
+    else if (command == "benchmark")
+        benchmarkLightBlending();
     else if (command == "help")
-        MessageSystem::addDebugMessage("Available commands: info | respawn | clear | help");
+        MessageSystem::addDebugMessage("Available commands: info | parallel | benchmark | respawn | clear | help");
     else
         MessageSystem::addDebugMessage("Unknown command: " + command, Warning);
 }
@@ -445,11 +663,35 @@ void GameState::init(Game* game)
 
 void GameState::save()
 {
-    SaveFile file(Game::saveFileName, true);
-    file.writeInt32(turn);
-    file.write(player->getPosition());
-    file.writeInt32(player->getLevel());
-    world.save(file);
+#ifdef _WIN32
+    // Windows can't replace a file while it's mapped into memory.
+    world.releaseSaveFile();
+#endif
+
+    // Write to a temporary file first so that a crash while saving doesn't corrupt the previous save.
+    auto temporaryFileName = std::string(Game::saveFileName) + ".tmp";
+
+    try
+    {
+        SaveFile file(temporaryFileName, true);
+        file.writeInt32(turn);
+        file.write(player->getPosition());
+        file.writeInt32(player->getLevel());
+        world.save(file);
+        file.close();
+    }
+    catch (...)
+    {
+        std::remove(temporaryFileName.c_str());
+        throw;
+    }
+
+    if (!fs::replace(temporaryFileName.c_str(), Game::saveFileName))
+        throw std::runtime_error("Unable to write " + std::string(Game::saveFileName));
+
+    // The areas that haven't been loaded yet were copied straight from the previous save file, and
+    // are read from the new one from now on.
+    world.switchSaveFile(SaveFile(Game::saveFileName, false));
 }
 
 void GameState::load(Game* game)
@@ -458,7 +700,7 @@ void GameState::load(Game* game)
     turn = file.readInt32();
     auto playerPosition = file.readVector2();
     auto playerLevel = file.readInt32();
-    world.load(file);
+    world.load(std::move(file));
 
     player = world.getTile(playerPosition, playerLevel)->getCreature();
     player->setController(std::make_unique<PlayerController>(*game));
@@ -467,6 +709,7 @@ void GameState::load(Game* game)
 
 void GameState::removeSaveFile()
 {
+    world.releaseSaveFile();
     std::remove(Game::saveFileName);
     isLoaded = false;
 }
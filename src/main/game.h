@@ -50,6 +50,8 @@ public:
     static std::unique_ptr<Config> itemConfig;
     static std::unique_ptr<Config> groundConfig;
     static std::unique_ptr<Config> materialConfig;
+    /// Loads the configs from their compiled forms, compiling the ones that are out of date.
+    static void loadConfigs();
     static std::unique_ptr<Texture> creatureSpriteSheet;
     static std::unique_ptr<Texture> objectSpriteSheet;
     static std::unique_ptr<Texture> itemSpriteSheet;
@@ -59,8 +61,18 @@ public:
 
     static constexpr auto saveFileName = "zenith.sav";
 
+    /// Sets the view of the window to show the world centered on the given tile, and returns the
+    /// region of tiles in view.
+    Rect setWorldView(Window&, Vector2 centerPosition) const;
     void renderAtPosition(Window&, Vector2 centerPosition);
     void render() override;
+    /// Marks the regions of the screen that have changed since the last call, for the world centered
+    /// on the given tile.
+    void markChangedRegions(Window&, Vector2 centerPosition);
+    void markChangedRegions() override;
+    /// Marks the tiles the mouse cursor moved between, for the world centered on the given tile.
+    void markCursor(Window&, Vector2 centerPosition);
+    void onMouseMove() override;
     void renderSidebar(BitmapFont& font) const;
     void printStat(BitmapFont&, std::string_view, double current, double max, Color) const;
     void printAttribute(BitmapFont&, std::string_view, double current) const;
@@ -68,6 +80,16 @@ public:
     bool gameIsRunning = true;
     GameState* gameState;
 
+    /// What the screen showed as of the last markChangedRegions call.
+    std::optional<Vector3> markedCenter;
+    std::optional<Vector2> markedCursorPosition;
+    bool markedSeesEverything = false;
+    FieldOfVision markedFieldOfVision;
+    uint64_t markedSightVersion = 0;
+    uint64_t markedStatsVersion = 0;
+    uint64_t markedMessagesVersion = 0;
+    int markedTurn = 0;
+
 #ifdef DEBUG
     void parseCommand(std::string_view);
     bool showExtraInfo = true;
@@ -18,6 +18,8 @@ public:
     static std::unique_ptr<Item> load(const SaveFile& file);
     virtual void save(SaveFile& file) const;
     virtual void exist() {}
+    /// Returns true if exist() may do something, i.e. the item changes over time.
+    virtual bool isActive() const { return false; }
     bool isUsable() const;
     bool use(Creature& user, Game& game);
     bool isEdible() const;
@@ -42,6 +44,7 @@ public:
     Corpse(std::unique_ptr<Creature> creature);
     Corpse(std::string_view creatureId);
     void exist() override;
+    bool isActive() const override { return creature != nullptr; }
     void renderEquipped(Window& window, Vector2 position) const override;
     void save(SaveFile& file) const override;
 
@@ -0,0 +1,109 @@
+#include "lighting.h"
+#include "area.h"
+#include "tile.h"
+#include "world.h"
+#include "components/lightsource.h"
+#include "engine/assert.h"
+#include "engine/raycast.h"
+#include <algorithm>
+
+bool LightEmitter::setLightSources(const std::vector<LightSource*>& lightSources)
+{
+    std::vector<Light> newLights;
+    newLights.reserve(lightSources.size());
+
+    for (auto* lightSource : lightSources)
+        newLights.push_back({ lightSource->getColor(), lightSource->getRadius() });
+
+    if (newLights == lights)
+        return false;
+
+    lights = std::move(newLights);
+    return true;
+}
+
+void LightEmitter::update(World& world)
+{
+    radius = 0;
+
+    for (auto& light : lights)
+    {
+        ASSERT(light.radius <= LightSource::maxRadius); // TODO: Convert to warning.
+        radius = std::max(radius, light.radius);
+    }
+
+    int diameter = radius * 2 + 1;
+    contribution.assign(diameter * diameter, Color::none);
+    auto sightMap = world.getSightMap(getRegion(), level);
+
+    for (int dx = -radius; dx <= radius; ++dx)
+    {
+        for (int dy = -radius; dy <= radius; ++dy)
+        {
+            auto targetPosition = position + Vector2(dx, dy);
+            std::optional<bool> isLit;
+            auto& targetLight = contribution[(dy + radius) * diameter + dx + radius];
+
+            for (auto& light : lights)
+            {
+                double reverseIntensity = Vector2(dx, dy).getLengthSquared() / double(light.radius * light.radius);
+
+                if (reverseIntensity >= 1.0)
+                    continue;
+
+                if (!isLit)
+                {
+                    isLit = raycast(position, targetPosition, [&](Vector2 point)
+                    {
+                        return !sightMap.isMissing(point) && (point == targetPosition || !sightMap.blocksSight(point));
+                    });
+                }
+
+                if (*isLit)
+                    targetLight.lighten(light.color * (1.0 - reverseIntensity));
+            }
+        }
+    }
+
+    isDirty = false;
+}
+
+void LightEmitter::apply(Area& area, Rect region) const
+{
+    if (contribution.empty())
+        return;
+
+    auto emitterRegion = getRegion();
+    auto areaRegion = area.getRegion();
+    int left = std::max({ region.getLeft(), emitterRegion.getLeft(), areaRegion.getLeft() });
+    int right = std::min({ region.getRight(), emitterRegion.getRight(), areaRegion.getRight() });
+    int top = std::max({ region.getTop(), emitterRegion.getTop(), areaRegion.getTop() });
+    int bottom = std::min({ region.getBottom(), emitterRegion.getBottom(), areaRegion.getBottom() });
+    int diameter = radius * 2 + 1;
+
+    if (left > right)
+        return;
+
+    for (int y = top; y <= bottom; ++y)
+    {
+        auto* light = &contribution[(y - emitterRegion.getTop()) * diameter + left - emitterRegion.getLeft()];
+        auto* tileLight = &area.layers->lights[(y - areaRegion.getTop()) * Area::size + left - areaRegion.getLeft()];
+
+        for (int x = left; x <= right; ++x, ++light, ++tileLight)
+        {
+            if (*light)
+                tileLight->lighten(*light);
+        }
+    }
+}
+
+Rect LightEmitter::getRegion() const
+{
+    return Rect(position - Vector2(radius, radius), Vector2(radius * 2 + 1, radius * 2 + 1));
+}
+
+bool LightEmitter::isWithinRadius(Vector2 otherPosition) const
+{
+    auto delta = abs(otherPosition - position);
+    return delta.x <= radius && delta.y <= radius;
+}
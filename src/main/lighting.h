@@ -0,0 +1,46 @@
+#pragma once
+
+#include "engine/color.h"
+#include "engine/geometry.h"
+#include <vector>
+
+class Area;
+class LightSource;
+class World;
+
+/// Cached light contribution of all light sources located on a single tile. The contribution is
+/// only recomputed when the emitter is marked dirty, i.e. when the light sources on its tile change
+/// or when a tile within its radius starts or stops blocking sight.
+class LightEmitter
+{
+public:
+    LightEmitter(Vector2 position, int level) : position(position), level(level), radius(0) {}
+    /// Returns true if the given light sources differ from the ones the emitter was last updated with.
+    bool setLightSources(const std::vector<LightSource*>& lightSources);
+    void update(World& world);
+    /// Adds the light to the tiles of the area that are within the given region.
+    void apply(Area& area, Rect region) const;
+    Rect getRegion() const;
+    bool isWithinRadius(Vector2 position) const;
+    Vector2 getPosition() const { return position; }
+
+    bool isDirty = true;
+
+private:
+    struct Light
+    {
+        Color color;
+        int radius;
+
+        bool operator==(const Light& other) const
+        {
+            return color.intValue() == other.color.intValue() && radius == other.radius;
+        }
+    };
+
+    Vector2 position;
+    int level;
+    int radius;
+    std::vector<Light> lights;
+    std::vector<Color> contribution;
+};
@@ -1,46 +1,72 @@
 #include "liquid.h"
 #include "game.h"
 #include "tile.h"
+#include "engine/assert.h"
 #include "engine/config.h"
 #include "engine/math.h"
+#include "engine/savefile.h"
+#include "engine/texture.h"
+#include <cmath>
+#include <vector>
+
+static const int splatSize = 3;
+
+/// Returns the texture containing the splats of all liquid materials, with the splat of each
+/// material at the position given by its type handle. Splats are drawn when first needed.
+static const Texture& getSplatAtlas(int material)
+{
+    static const Texture atlas(SDL_PIXELFORMAT_RGBA8888, Vector2(Game::materialConfig->getTypeCount() * splatSize, splatSize));
+    static std::vector<bool> hasSplat(size_t(Game::materialConfig->getTypeCount()));
+
+    if (!hasSplat[material])
+    {
+        SDL_Rect splatRectangle = { material * splatSize, 0, splatSize, splatSize };
+        auto materialId = Game::materialConfig->getTypeId(material);
+        auto color = Color(Game::materialConfig->get<uint32_t>(materialId, "Color"));
+        SDL_FillRect(atlas.surface.get(), &splatRectangle, color.intValue());
+        hasSplat[material] = true;
+    }
+
+    return atlas;
+}
 
 Liquid::Liquid(std::string_view materialId)
-:   materialId(materialId),
-    fadeLevel(1.0),
-    texture(SDL_PIXELFORMAT_RGBA8888, Tile::getSize())
+:   fadeLevel(maxFadeLevel)
 {
-    int width = 3;
-    int height = 3;
-    Vector2 position(randInt(Tile::getSize().x - width), randInt(Tile::getSize().y - height));
-    SDL_Rect liquidRectangle = { position.x, position.y, width, height };
-    auto color = Color(Game::materialConfig->get<uint32_t>(materialId, "Color"));
-    SDL_FillRect(texture.surface.get(), &liquidRectangle, color.intValue());
+    auto materialHandle = Game::materialConfig->getTypeHandle(materialId);
+    ASSERT(materialHandle != Config::invalidHandle && materialHandle < 0x100);
+    material = uint8_t(materialHandle);
+    offsetX = uint8_t(randInt(Tile::getSize().x - splatSize));
+    offsetY = uint8_t(randInt(Tile::getSize().y - splatSize));
 }
 
 Liquid::Liquid(const SaveFile& file)
 :   Liquid(file.readString())
 {
-    fadeLevel = file.readDouble();
+    fadeLevel = uint16_t(std::lround(file.readDouble() * maxFadeLevel));
 }
 
 void Liquid::save(SaveFile& file) const
 {
-    file.write(materialId);
-    file.write(fadeLevel);
+    file.write(Game::materialConfig->getTypeId(material));
+    file.write(double(fadeLevel) / maxFadeLevel);
 }
 
 void Liquid::exist()
 {
-    fadeLevel = std::max(0.0, fadeLevel - fadeRate);
+    if (fadeLevel > 0)
+        --fadeLevel;
 }
 
 bool Liquid::exists() const
 {
-    return fadeLevel > 0.0;
+    return fadeLevel > 0;
 }
 
 void Liquid::render(Window& window, Vector2 position) const
 {
-    SDL_SetSurfaceAlphaMod(texture.surface.get(), uint8_t(fadeLevel * 255));
-    texture.render(window, position);
+    auto& atlas = getSplatAtlas(material);
+    atlas.setColor(Color(0xFF, 0xFF, 0xFF, getAlpha()));
+    atlas.render(window, Rect(material * splatSize, 0, splatSize, splatSize),
+                 Rect(position + Vector2(offsetX, offsetY), Vector2(splatSize, splatSize)));
 }
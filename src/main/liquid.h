@@ -1,11 +1,13 @@
 #pragma once
 
-#include "engine/texture.h"
+#include "engine/geometry.h"
+#include <cstdint>
 #include <string_view>
 
 class SaveFile;
 class Window;
 
+/// A splat of liquid on a tile. Kept small, as bleeding creatures leave thousands of them behind.
 class Liquid
 {
 public:
@@ -15,11 +17,16 @@ public:
     void exist();
     bool exists() const;
     void render(Window& window, Vector2 position) const;
+    uint8_t getAlpha() const { return uint8_t(fadeLevel * 255 / maxFadeLevel); }
 
 private:
-    static constexpr double fadeRate = 0.001;
+    /// The number of turns it takes for a liquid to fade away.
+    static const int maxFadeLevel = 1000;
 
-    std::string materialId;
-    double fadeLevel;
-    Texture texture;
+    uint16_t fadeLevel;
+    /// The type handle of the material in the material config.
+    uint8_t material;
+    /// The position of the splat within the tile.
+    uint8_t offsetX;
+    uint8_t offsetY;
 };
@@ -52,11 +52,12 @@ private:
 
 static const auto preferencesFileName = "prefs.cfg";
 
-static void savePreferencesToFile(double graphicsScale, bool fullscreen)
+static void savePreferencesToFile(double graphicsScale, bool fullscreen, int maxFrameRate)
 {
     Config preferences;
     preferences.set("GraphicsScale", graphicsScale);
     preferences.set("Fullscreen", fullscreen);
+    preferences.set("MaxFrameRate", static_cast<long long>(maxFrameRate));
     saveKeyMap(preferences);
     preferences.writeToFile(preferencesFileName);
 }
@@ -112,6 +113,7 @@ StateChange KeyMapMenu::update()
     {
         case ResetDefaults:
             loadKeyMap(nullptr);
+            markDirty();
             return StateChange::None();
 
         case Menu::Exit:
@@ -121,7 +123,10 @@ StateChange KeyMapMenu::update()
             auto event = window->waitForInput();
 
             if (event.type == Event::KeyDown && getMappedAction(event.key) == NoAction)
+            {
                 mapKey(event.key, static_cast<Action>(selection));
+                markDirty();
+            }
 
             return StateChange::None();
     }
@@ -160,13 +165,14 @@ StateChange PrefsMenu::update()
 
         case Fullscreen:
             window->toggleFullscreen();
+            markDirty();
             return StateChange::None();
 
         case KeyMap:
             return StateChange::Push(std::make_unique<KeyMapMenu>());
 
         case Menu::Exit:
-            savePreferencesToFile(window->context.getScale(), window->isFullscreen());
+            savePreferencesToFile(window->context.getScale(), window->isFullscreen(), window->context.getMaxFrameRate());
             return StateChange::Pop();
 
         default:
@@ -249,6 +255,12 @@ int main(int argc, char** argv)
         return 0;
     }
 
+    if (argc == 2 && std::string(argv[1]) == "--compile-configs")
+    {
+        Game::loadConfigs();
+        return 0;
+    }
+
     GameState gameState;
     StateManager stateManager;
     std::optional<Window> window;
@@ -264,6 +276,7 @@ int main(int argc, char** argv)
             Config preferences(preferencesFileName);
             window->context.setScale(preferences.getOptional<double>("GraphicsScale").value_or(1));
             window->setFullscreen(preferences.getOptional<bool>("Fullscreen").value_or(true));
+            window->context.setMaxFrameRate(preferences.getOptional<int>("MaxFrameRate").value_or(60));
             loadKeyMap(&preferences);
         }
         else
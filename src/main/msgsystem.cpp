@@ -1,6 +1,7 @@
 #include "msgsystem.h"
 #include "gui.h"
 #include "engine/color.h"
+#include "engine/window.h"
 
 void Message::save(SaveFile& file) const
 {
@@ -41,24 +42,30 @@ namespace MessageSystem
 void MessageSystem::drawMessages(Window& window, BitmapFont& font,
                                  const std::vector<Message>& messages, int currentTurn)
 {
-    font.setArea(GUI::getMessageArea(window));
-    for (int end = int(messages.size()), i = std::max(0, end - maxMessagesToPrint); i < end; ++i)
+    if (window.context.isDirty(GUI::getMessageArea(window)))
     {
-        bool isNewMessage = messages[i].turn >= currentTurn - 1;
-        auto color = isNewMessage ? White : Gray;
-        font.print(window, "- ", color);
-        std::string text = messages[i].text;
+        font.setArea(GUI::getMessageArea(window));
+        for (int end = int(messages.size()), i = std::max(0, end - maxMessagesToPrint); i < end; ++i)
+        {
+            bool isNewMessage = messages[i].turn >= currentTurn - 1;
+            auto color = isNewMessage ? White : Gray;
+            font.print(window, "- ", color);
+            std::string text = messages[i].text;
 
-        if (messages[i].count > 1)
-            text += " (x" + std::to_string(messages[i].count) + ")";
+            if (messages[i].count > 1)
+                text += " (x" + std::to_string(messages[i].count) + ")";
 
-        font.printLine(window, text, color, Color::none, true, SplitLines);
+            font.printLine(window, text, color, Color::none, true, SplitLines);
+        }
     }
 
 #ifdef DEBUG
-    font.setArea(GUI::getDebugMessageArea(window));
-    for (const DebugMessage& message : debugMessages)
-        font.printLine(window, message.content, messageColors[message.type]);
+    if (window.context.isDirty(GUI::getDebugMessageArea(window)))
+    {
+        font.setArea(GUI::getDebugMessageArea(window));
+        for (const DebugMessage& message : debugMessages)
+            font.printLine(window, message.content, messageColors[message.type]);
+    }
 #endif
 }
 
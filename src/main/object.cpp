@@ -42,7 +42,8 @@ bool Object::blocksSight() const
         if (component->blocksSight())
             return true;
 
-    return Game::objectConfig->get<bool>(getId(), "blocksSight");
+    static const auto blocksSightAttribute = Config::getAttributeHandle("blocksSight");
+    return getConfig().get<bool>(getTypeHandle(), blocksSightAttribute);
 }
 
 void Object::render(Window& window, Vector2 position) const
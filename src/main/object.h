@@ -16,6 +16,7 @@ public:
     bool blocksSight() const;
     void render(Window& window, Vector2 position) const;
     Sprite& getSprite() { return sprite; }
+    const Sprite& getSprite() const { return sprite; }
 
 private:
     Sprite sprite;
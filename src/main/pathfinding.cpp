@@ -0,0 +1,136 @@
+#include "pathfinding.h"
+#include "tile.h"
+#include "world.h"
+#include "engine/assert.h"
+#include <algorithm>
+#include <climits>
+
+PathFinder::Node& PathFinder::getNode(int index, const std::function<Tile*(Vector2)>& getTile,
+                                     const std::function<bool(Tile&)>& isAllowed)
+{
+    auto& node = nodes[index];
+
+    if (node.generation != generation)
+    {
+        Vector2 position(window.getLeft() + index % window.getWidth(), window.getTop() + index / window.getWidth());
+        node.generation = generation;
+        node.isClosed = false;
+        node.cost = INT_MAX;
+        node.parent = -1;
+        node.tile = getTile(position);
+        node.isAllowed = node.tile && isAllowed(*node.tile);
+    }
+
+    return node;
+}
+
+int PathFinder::getHeuristic(int index, Vector2 target, bool allowDiagonals) const
+{
+    Vector2 position(window.getLeft() + index % window.getWidth(), window.getTop() + index / window.getWidth());
+    Vector2 distance = abs(target - position);
+    return allowDiagonals ? std::max(distance.x, distance.y) : distance.x + distance.y;
+}
+
+std::vector<Tile*> PathFinder::findPath(Tile& source, Tile& target, const std::function<bool(Tile&)>& isAllowed,
+                                        bool allowDiagonals, const std::function<Tile*(Vector2)>& getTile)
+{
+    ASSERT(source.getLevel() == target.getLevel());
+
+    auto topLeft = Vector2(std::min(source.getPosition().x, target.getPosition().x),
+                           std::min(source.getPosition().y, target.getPosition().y));
+    auto bottomRight = Vector2(std::max(source.getPosition().x, target.getPosition().x),
+                               std::max(source.getPosition().y, target.getPosition().y));
+    auto margin = Vector2(searchMargin, searchMargin);
+    window = Rect(topLeft - margin, bottomRight - topLeft + Vector2(1, 1) + margin * 2);
+
+    auto& world = source.getWorld();
+    int level = source.getLevel();
+    std::function<Tile*(Vector2)> getWorldTile = [&](Vector2 position) { return world.getTile(position, level); };
+    auto& getWindowTile = getTile ? getTile : getWorldTile;
+
+    if (size_t(window.getArea()) > nodes.size())
+    {
+        nodes.resize(window.getArea());
+        std::fill(nodes.begin(), nodes.end(), Node { 0, false, false, 0, -1, nullptr });
+        generation = 0;
+    }
+
+    if (++generation == 0)
+    {
+        std::fill(nodes.begin(), nodes.end(), Node { 0, false, false, 0, -1, nullptr });
+        generation = 1;
+    }
+
+    auto getIndex = [&](Vector2 position)
+    {
+        return (position.y - window.getTop()) * window.getWidth() + position.x - window.getLeft();
+    };
+
+    // Min-heap of (estimated total cost, node index). Outdated entries are skipped when popped.
+    auto compare = [](const std::pair<int, int>& a, const std::pair<int, int>& b) { return a.first > b.first; };
+    openSet.clear();
+
+    int sourceIndex = getIndex(source.getPosition());
+    int targetIndex = getIndex(target.getPosition());
+    getNode(sourceIndex, getWindowTile, isAllowed).cost = 0;
+    openSet.emplace_back(getHeuristic(sourceIndex, target.getPosition(), allowDiagonals), sourceIndex);
+
+    while (!openSet.empty())
+    {
+        std::pop_heap(openSet.begin(), openSet.end(), compare);
+        int currentIndex = openSet.back().second;
+        openSet.pop_back();
+
+        auto& current = nodes[currentIndex];
+
+        if (current.isClosed)
+            continue;
+
+        if (currentIndex == targetIndex)
+        {
+            std::vector<Tile*> path;
+
+            for (int index = currentIndex; index != -1; index = nodes[index].parent)
+                path.push_back(nodes[index].tile);
+
+            std::reverse(path.begin(), path.end());
+            return path;
+        }
+
+        current.isClosed = true;
+        Vector2 currentPosition(window.getLeft() + currentIndex % window.getWidth(),
+                                window.getTop() + currentIndex / window.getWidth());
+
+        for (int direction = East; direction <= NorthEast; ++direction)
+        {
+            auto dir = static_cast<Dir8>(direction);
+
+            if (!allowDiagonals && dir != North && dir != East && dir != South && dir != West)
+                continue;
+
+            auto neighborPosition = currentPosition + dir;
+
+            if (!neighborPosition.isWithin(window))
+                continue;
+
+            int neighborIndex = getIndex(neighborPosition);
+            auto& neighbor = getNode(neighborIndex, getWindowTile, isAllowed);
+
+            if (!neighbor.isAllowed || neighbor.isClosed)
+                continue;
+
+            int tentativeCost = current.cost + 1;
+
+            if (tentativeCost >= neighbor.cost)
+                continue;
+
+            neighbor.cost = tentativeCost;
+            neighbor.parent = currentIndex;
+            openSet.emplace_back(tentativeCost + getHeuristic(neighborIndex, target.getPosition(), allowDiagonals),
+                                 neighborIndex);
+            std::push_heap(openSet.begin(), openSet.end(), compare);
+        }
+    }
+
+    return {};
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "engine/geometry.h"
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+class Tile;
+
+/// A* pathfinder that searches within a window around the source and target tiles. The per-tile
+/// search state is kept in flat arrays indexed by position within the window, which are reused
+/// between searches and reset lazily using a generation counter.
+class PathFinder
+{
+public:
+    /// Returns the tiles on a shortest path from `source` to `target`, both included, or an empty
+    /// vector if there is no path within the search window. Only pre-existing tiles for which
+    /// `isAllowed` returns true are entered. Movement is 4-directional unless `allowDiagonals` is set.
+    /// Tiles are looked up from the world, or with `getTile` if it's given.
+    std::vector<Tile*> findPath(Tile& source, Tile& target, const std::function<bool(Tile&)>& isAllowed,
+                                bool allowDiagonals = false, const std::function<Tile*(Vector2)>& getTile = nullptr);
+
+    /// How far the search window extends beyond the bounding box of the source and target.
+    static const int searchMargin = 32;
+
+private:
+    struct Node
+    {
+        uint32_t generation;
+        bool isClosed;
+        bool isAllowed;
+        int cost;
+        int parent;
+        Tile* tile;
+    };
+
+    Node& getNode(int index, const std::function<Tile*(Vector2)>& getTile, const std::function<bool(Tile&)>& isAllowed);
+    int getHeuristic(int index, Vector2 target, bool allowDiagonals) const;
+
+    Rect window;
+    std::vector<Node> nodes;
+    std::vector<std::pair<int, int>> openSet;
+    uint32_t generation = 0;
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "engine/geometry.h"
+#include <cstdint>
+#include <vector>
+
+/// Snapshot of the tiles of a region as seen by rays and field of vision sweeps. Stored in a flat
+/// array, so that each step of a sweep is an array index instead of a lookup from the world.
+class SightMap
+{
+public:
+    enum Flags : uint8_t
+    {
+        Missing = 1 << 0,
+        BlocksSight = 1 << 1,
+        /// Set for tiles whose light is too dim for anything on them to be seen.
+        Dark = 1 << 2
+    };
+
+    SightMap(Rect region) : region(region), flags(size_t(region.getArea()), Missing) {}
+    Rect getRegion() const { return region; }
+    /// Positions outside the region are treated as missing tiles.
+    uint8_t getFlags(Vector2 position) const;
+    void setFlags(Vector2 position, uint8_t newFlags) { flags[getIndex(position)] = newFlags; }
+    bool isMissing(Vector2 position) const { return getFlags(position) & Missing; }
+    bool blocksSight(Vector2 position) const { return getFlags(position) & BlocksSight; }
+    bool isDark(Vector2 position) const { return getFlags(position) & Dark; }
+
+    static constexpr double darknessThreshold = 0.3;
+
+private:
+    int getIndex(Vector2 position) const
+    {
+        return (position.y - region.getTop()) * region.getWidth() + position.x - region.getLeft();
+    }
+
+    Rect region;
+    std::vector<uint8_t> flags;
+};
+
+inline uint8_t SightMap::getFlags(Vector2 position) const
+{
+    if (!position.isWithin(region))
+        return Missing;
+
+    return flags[getIndex(position)];
+}
@@ -5,54 +5,130 @@
 #include "world.h"
 #include "components/lightsource.h"
 #include "engine/savefile.h"
+#include "engine/assert.h"
+#include "engine/config.h"
+#include "engine/math.h"
 #include "engine/texture.h"
+#include <algorithm>
 #include <cmath>
 
 const Vector2 Tile::spriteSize(20, 20);
 
-Tile::Tile(World& world, Vector2 position, int level, std::string_view groundId)
+namespace
+{
+    struct Ground
+    {
+        std::string id;
+        std::vector<Sprite> variants;
+    };
+}
+
+static const std::vector<Ground>& getGrounds()
+{
+    // Initialized once, so that tiles can be created on any thread.
+    static const std::vector<Ground> grounds = []
+    {
+        std::vector<Ground> grounds;
+        auto& config = *Game::groundConfig;
+
+        for (auto& id : config.getToplevelKeys())
+        {
+            auto components = config.get<std::vector<int>>(id, "spritePosition");
+            auto animationFrames = config.get<int>(id, "animationFrames");
+            std::vector<Sprite> variants;
+
+            for (int offsetX = 0; offsetX < config.get<int>(id, "spriteMultiplicity"); ++offsetX)
+            {
+                Rect textureRegion(Vector2(components.at(0) + offsetX, components.at(1)) * Tile::spriteSize, Tile::spriteSize);
+                variants.emplace_back(*Game::groundSpriteSheet, textureRegion, Color::none, animationFrames);
+            }
+
+            grounds.push_back({ id, std::move(variants) });
+        }
+
+        ASSERT(grounds.size() <= 0x100);
+        return grounds;
+    }();
+
+    return grounds;
+}
+
+TileLayers::TileLayers(World& world, int level, int tileCount)
 :   world(world),
-    position(position),
     level(level),
-    groundId(groundId),
-    groundSprite(getSprite(*Game::groundSpriteSheet, *Game::groundConfig, groundId)),
-    light(Color::black)
+    grounds(size_t(tileCount)),
+    groundVariants(size_t(tileCount)),
+    lights(size_t(tileCount), Color::black),
+    sightBlocking(size_t(tileCount)),
+    creatures(size_t(tileCount)),
+    objects(size_t(tileCount)),
+    staticLayerDirty(size_t(tileCount), true),
+    activeTiles((size_t(tileCount) + 63) / 64),
+    changedTiles((size_t(tileCount) + 63) / 64)
 {
 }
 
-Tile::Tile(const SaveFile& file, World& world, Vector2 position, int level)
-:   world(world),
+Tile::Tile(TileLayers& layers, int index, Vector2 position, std::string_view groundId)
+:   layers(layers),
     position(position),
-    level(level),
-    groundId(file.readString()),
-    groundSprite(getSprite(*Game::groundSpriteSheet, *Game::groundConfig, groundId)),
-    light(Color::black)
+    index(index)
+{
+    setGround(groundId);
+}
+
+Tile::Tile(const SaveFile& file, TileLayers& layers, int index, Vector2 position)
+:   layers(layers),
+    position(position),
+    index(index)
 {
+    setGround(file.readString());
+
     if (file.readBool())
         spawnCreature(file);
 
-    auto itemCount = file.readInt32();
-    items.reserve(size_t(itemCount));
-    for (int i = 0; i < itemCount; ++i)
-        items.push_back(Item::load(file));
+    if (auto itemCount = file.readInt32())
+    {
+        auto& items = layers.items[index];
+        items.reserve(size_t(itemCount));
+        for (int i = 0; i < itemCount; ++i)
+        {
+            items.push_back(Item::load(file));
+
+            if (items.back()->isActive())
+                setActive(true);
+        }
+    }
+
+    if (auto liquidCount = file.readInt32())
+    {
+        auto& liquids = layers.liquids[index];
+        liquids.reserve(size_t(liquidCount));
+        for (int i = 0; i < liquidCount; ++i)
+            liquids.push_back(Liquid(file));
 
-    auto liquidCount = file.readInt32();
-    liquids.reserve(size_t(liquidCount));
-    for (int i = 0; i < liquidCount; ++i)
-        liquids.push_back(Liquid(file));
+        setActive(true);
+    }
 
     if (file.readBool())
-        object = std::make_unique<Object>(file);
+    {
+        layers.objects[index] = std::make_unique<Object>(file);
+        layers.sightBlocking[index] = layers.objects[index]->blocksSight();
+    }
 }
 
 void Tile::save(SaveFile& file) const
 {
-    file.write(groundId);
+    static const std::vector<Liquid> noLiquids;
+    auto liquids = layers.liquids.find(index);
+    auto* creature = getCreature();
+    auto* object = getObject();
+
+    file.write(getGroundId());
     file.write(creature != nullptr);
     if (creature)
         creature->save(file);
-    file.write(items);
-    file.write(liquids);
+    file.write(getItems());
+    file.write(liquids != layers.liquids.end() ? liquids->second : noLiquids);
     file.write(object != nullptr);
     if (object)
         object->save(file);
@@ -60,44 +136,90 @@ void Tile::save(SaveFile& file) const
 
 void Tile::exist()
 {
-    for (auto it = liquids.begin(); it != liquids.end();)
+    auto liquidsIterator = layers.liquids.find(index);
+    bool isActive = false;
+
+    if (liquidsIterator != layers.liquids.end())
     {
-        if (it->exists())
+        auto& liquids = liquidsIterator->second;
+
+        for (auto it = liquids.begin(); it != liquids.end();)
         {
-            it->exist();
-            ++it;
+            if (it->exists())
+            {
+                auto oldAlpha = it->getAlpha();
+                it->exist();
+
+                if (it->getAlpha() != oldAlpha)
+                    invalidateStaticLayer();
+
+                ++it;
+            }
+            else
+            {
+                it = liquids.erase(it);
+                invalidateStaticLayer();
+            }
         }
+
+        if (liquids.empty())
+            layers.liquids.erase(liquidsIterator);
         else
-            it = liquids.erase(it);
+            isActive = true;
+    }
+
+    auto items = layers.items.find(index);
+
+    if (items != layers.items.end())
+    {
+        for (auto& item : items->second)
+        {
+            item->exist();
+            isActive = isActive || item->isActive();
+        }
     }
 
-    for (auto& item : items)
-        item->exist();
+    if (!isActive)
+        setActive(false);
+}
+
+void Tile::setActive(bool active)
+{
+    auto& word = layers.activeTiles[size_t(index) / 64];
+    uint64_t bit = uint64_t(1) << (index % 64);
+    word = active ? word | bit : word & ~bit;
 }
 
-void Tile::render(Window& window, bool fogOfWar, bool renderLight) const
+void Tile::markChanged()
+{
+    layers.changedTiles[size_t(index) / 64] |= uint64_t(1) << (index % 64);
+}
+
+void Tile::render(Window& window, bool fogOfWar, bool renderLight, bool staticLayerRendered) const
 {
     Vector2 renderPosition = position * getSize();
-    groundSprite.render(window, renderPosition);
 
-    for (auto& liquid : liquids)
-        liquid.render(window, renderPosition);
+    if (!staticLayerRendered)
+        renderGroundAndLiquids(window, renderPosition);
 
-    for (auto& item : items)
+    for (auto& item : getItems())
         item->render(window, renderPosition);
 
-    if (object)
-        object->render(window, renderPosition);
+    if (!staticLayerRendered)
+    {
+        if (auto* object = getObject())
+            object->render(window, renderPosition);
+    }
 
     if (fogOfWar)
         Game::fogOfWarTexture->render(window, renderPosition, getSize());
     else
     {
-        if (creature)
+        if (auto* creature = getCreature())
             creature->render(window, renderPosition);
 
         if (renderLight)
-            window.context.renderFilledRectangle(Rect(renderPosition, getSize()), light, BlendMode::LinearLight);
+            window.context.renderFilledRectangle(Rect(renderPosition, getSize()), getLight(), BlendMode::LinearLight);
     }
 
     Rect tileRect(renderPosition, getSize());
@@ -112,20 +234,82 @@ void Tile::render(Window& window, bool fogOfWar, bool renderLight) const
         auto cursorColor = Color(0xFF, 0xFF, 0xFF, currentAlpha * 0xFF);
         Game::cursorTexture->setColor(cursorColor);
         Game::cursorTexture->render(window, tileRect);
+
+        int cursorFrameTime = 50;
+        window.context.scheduleFrame(cursorFrameTime, tileRect);
     }
 }
 
+void Tile::renderGroundAndLiquids(Window& window, Vector2 renderPosition) const
+{
+    getGrounds()[layers.grounds[index]].variants[layers.groundVariants[index]].render(window, renderPosition);
+
+    auto liquids = layers.liquids.find(index);
+
+    if (liquids != layers.liquids.end())
+    {
+        for (auto& liquid : liquids->second)
+            liquid.render(window, renderPosition);
+    }
+}
+
+bool Tile::hasStaticAppearance() const
+{
+    if (getGrounds()[layers.grounds[index]].variants[layers.groundVariants[index]].isAnimated())
+        return false;
+
+    if (auto* object = getObject())
+        return !object->getSprite().isAnimated() && !hasItems();
+
+    return true;
+}
+
+void Tile::updateStaticLayer(Window& window) const
+{
+    if (!layers.staticLayer)
+    {
+        layers.staticLayer = std::make_unique<Texture>(SDL_PIXELFORMAT_RGBA8888, Area::sizeVector * getSize());
+        layers.staticLayer->setBlendMode(false);
+        std::fill(layers.staticLayerDirty.begin(), layers.staticLayerDirty.end(), true);
+    }
+    else if (!layers.staticLayerDirty[index])
+        return;
+
+    window.context.renderToTexture(*layers.staticLayer, [&]
+    {
+        Vector2 layerPosition = getStaticLayerPosition();
+        window.context.renderFilledRectangle(Rect(layerPosition, getSize()), Color::none);
+        renderGroundAndLiquids(window, layerPosition);
+
+        if (auto* object = getObject())
+            object->render(window, layerPosition);
+    });
+
+    layers.staticLayerDirty[index] = false;
+}
+
+void Tile::renderStaticLayer(Window& window, int count) const
+{
+    Vector2 size(getSize().x * count, getSize().y);
+    layers.staticLayer->render(window, Rect(getStaticLayerPosition(), size), Rect(position * getSize(), size));
+}
+
+Vector2 Tile::getStaticLayerPosition() const
+{
+    return Vector2(index % Area::size, index / Area::size) * getSize();
+}
+
 std::string Tile::getTooltip() const
 {
     std::vector<std::string> strings;
 
-    if (creature)
+    if (auto* creature = getCreature())
         strings.push_back(creature->getNameIndefinite());
 
-    for (auto& item : reverse(items))
+    for (auto& item : reverse(getItems()))
         strings.push_back(item->getNameIndefinite());
 
-    if (object)
+    if (auto* object = getObject())
         strings.push_back(object->getNameIndefinite());
 
     return join(strings, ", ");
@@ -133,121 +317,153 @@ std::string Tile::getTooltip() const
 
 Creature* Tile::spawnCreature(std::string_view id, std::unique_ptr<Controller> controller)
 {
-    auto creature = world.addCreature(std::make_unique<Creature>(this, id, std::move(controller)));
+    auto creature = getWorld().addCreature(std::make_unique<Creature>(this, id, std::move(controller)));
     setCreature(creature);
     return creature;
 }
 
 Creature* Tile::spawnCreature(const SaveFile& file)
 {
-    auto creature = world.addCreature(std::make_unique<Creature>(this, file));
+    auto creature = getWorld().addCreature(std::make_unique<Creature>(this, file));
     setCreature(creature);
     return creature;
 }
 
+void Tile::setCreature(Creature* creature)
+{
+    if (hasCreature())
+        getWorld().onCreatureLeft(*this);
+
+    layers.creatures[index] = creature;
+
+    if (creature)
+        getWorld().onCreatureEntered(*this);
+
+    getWorld().invalidateLightSources(position, getLevel());
+    markChanged();
+}
+
 void Tile::removeCreature()
 {
-    creature = nullptr;
+    if (hasCreature())
+        getWorld().onCreatureLeft(*this);
+
+    layers.creatures[index] = nullptr;
+    getWorld().invalidateLightSources(position, getLevel());
+    markChanged();
+}
+
+const std::vector<std::unique_ptr<Item>>& Tile::getItems() const
+{
+    static const std::vector<std::unique_ptr<Item>> noItems;
+    auto items = layers.items.find(index);
+    return items != layers.items.end() ? items->second : noItems;
 }
 
 std::unique_ptr<Item> Tile::removeTopmostItem()
 {
-    auto item = std::move(items.back());
-    items.pop_back();
+    auto items = layers.items.find(index);
+    auto item = std::move(items->second.back());
+    items->second.pop_back();
+
+    if (items->second.empty())
+        layers.items.erase(items);
+
+    getWorld().invalidateLightSources(position, getLevel());
+    markChanged();
     return item;
 }
 
 void Tile::addItem(std::unique_ptr<Item> item)
 {
-    items.push_back(std::move(item));
+    if (item->isActive())
+        setActive(true);
+
+    layers.items[index].push_back(std::move(item));
+    getWorld().invalidateLightSources(position, getLevel());
+    markChanged();
 }
 
 void Tile::addLiquid(std::string_view materialId)
 {
-    liquids.push_back(Liquid(materialId));
+    layers.liquids[index].push_back(Liquid(materialId));
+    invalidateStaticLayer();
+    setActive(true);
 }
 
 void Tile::setObject(std::unique_ptr<Object> newObject)
 {
-    object = std::move(newObject);
+    layers.objects[index] = std::move(newObject);
+    getWorld().invalidateLightSources(position, getLevel());
+    onObjectChanged();
 }
 
-void Tile::setGround(std::string_view groundId)
+void Tile::onObjectChanged()
 {
-    this->groundId = groundId;
-    groundSprite = getSprite(*Game::groundSpriteSheet, *Game::groundConfig, groundId);
+    invalidateStaticLayer();
+    layers.sightBlocking[index] = hasObject() && getObject()->blocksSight();
+    getWorld().invalidateSightBlocking(position, getLevel());
 }
 
-std::vector<Entity*> Tile::getEntities() const
+std::string_view Tile::getGroundId() const
 {
-    std::vector<Entity*> entities;
-
-    if (creature)
-    {
-        entities.push_back(creature);
-
-        for (auto item : creature->getEquipment())
-            if (item)
-                entities.push_back(item);
-    }
-
-    for (auto& item : items)
-        entities.push_back(item.get());
-
-    if (object)
-        entities.push_back(object.get());
-
-    return entities;
+    return getGrounds()[layers.grounds[index]].id;
 }
 
-std::vector<LightSource*> Tile::getLightSources() const
+void Tile::setGround(std::string_view groundId)
 {
-    std::vector<LightSource*> lightSources;
-
-    for (auto* entity : getEntities())
-        for (auto* lightSource : entity->getComponentsOfType<LightSource>())
-            lightSources.push_back(lightSource);
-
-    return lightSources;
+    auto& grounds = getGrounds();
+    auto ground = std::find_if(grounds.begin(), grounds.end(), [&](auto& ground) { return ground.id == groundId; });
+    ASSERT(ground != grounds.end());
+    layers.grounds[index] = uint8_t(ground - grounds.begin());
+    layers.groundVariants[index] = uint8_t(randInt(ground->variants.size() - 1));
+    invalidateStaticLayer();
 }
 
-void Tile::emitLight()
+std::vector<Entity*> Tile::getEntities() const
 {
-    for (auto* lightSource : getLightSources())
-        lightSource->emitLight(world, getCenterPosition(), level);
+    std::vector<Entity*> entities;
+    forEachEntity([&](Entity& entity) { entities.push_back(&entity); });
+    return entities;
 }
 
-void Tile::resetLight()
+bool Tile::hasLightSources() const
 {
-    if (getLevel() >= 0)
-        light = world.getSunlight();
-    else
-        light = Color::black;
+    bool hasLightSources = false;
+    forEachEntity([&](Entity& entity) { hasLightSources |= entity.hasComponentOfType<LightSource>(); });
+    return hasLightSources;
 }
 
-bool Tile::blocksSight() const
+std::vector<LightSource*> Tile::getLightSources() const
 {
-    return hasObject() && getObject()->blocksSight();
+    std::vector<LightSource*> lightSources;
+
+    forEachEntity([&](Entity& entity)
+    {
+        entity.forEachComponentOfType<LightSource>([&](LightSource& lightSource) { lightSources.push_back(&lightSource); });
+    });
+
+    return lightSources;
 }
 
 Tile* Tile::getAdjacentTile(Dir8 direction) const
 {
-    return getWorld().getOrCreateTile(getPosition() + direction, level);
+    return getWorld().getOrCreateTile(getPosition() + direction, getLevel());
 }
 
 Tile* Tile::getPreExistingAdjacentTile(Dir8 direction) const
 {
-    return getWorld().getTile(getPosition() + direction, level);
+    return getWorld().getTile(getPosition() + direction, getLevel());
 }
 
 Tile* Tile::getTileBelow() const
 {
-    return getWorld().getOrCreateTile(getPosition(), level - 1);
+    return getWorld().getOrCreateTile(getPosition(), getLevel() - 1);
 }
 
 Tile* Tile::getTileAbove() const
 {
-    return getWorld().getOrCreateTile(getPosition(), level + 1);
+    return getWorld().getOrCreateTile(getPosition(), getLevel() + 1);
 }
 
 Vector2 Tile::getSize()
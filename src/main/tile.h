@@ -8,8 +8,11 @@
 #include "engine/color.h"
 #include "engine/geometry.h"
 #include "engine/sprite.h"
+#include "engine/texture.h"
+#include <cstdint>
 #include <string_view>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 class Area;
@@ -19,60 +22,123 @@ class SaveFile;
 class Window;
 class World;
 
+/// The state of all tiles of an area, in arrays indexed by tile. The state read by the lighting, field
+/// of vision and rendering loops is stored densely, while items and liquids, which most tiles don't
+/// have, are stored in sparse tables.
+struct TileLayers
+{
+    TileLayers(World& world, int level, int tileCount);
+
+    World& world;
+    int level;
+    std::vector<uint8_t> grounds;
+    std::vector<uint8_t> groundVariants;
+    std::vector<Color> lights;
+    std::vector<uint8_t> sightBlocking;
+    std::vector<Creature*> creatures;
+    /// Stored densely, as every underground tile has an object.
+    std::vector<std::unique_ptr<Object>> objects;
+    std::unordered_map<int, std::vector<std::unique_ptr<Item>>> items;
+    std::unordered_map<int, std::vector<Liquid>> liquids;
+    /// The grounds, liquids and objects of the tiles pre-rendered, so that tiles whose appearance
+    /// isn't animated can be rendered with one blit per row. Created when the area is first rendered.
+    std::unique_ptr<Texture> staticLayer;
+    /// Whether each tile has changed since it was last rendered to the static layer.
+    std::vector<uint8_t> staticLayerDirty;
+    /// A bit per tile, set for the tiles that have liquids or active items. Only these tiles are
+    /// updated by World::exist.
+    std::vector<uint64_t> activeTiles;
+    /// A bit per tile, set for the tiles whose appearance has changed since the game last marked
+    /// them to be redrawn.
+    std::vector<uint64_t> changedTiles;
+};
+
 class Tile
 {
 public:
-    Tile(World& world, Vector2 position, int level, std::string_view groundId);
-    Tile(const SaveFile& file, World& world, Vector2 position, int level);
+    Tile(TileLayers& layers, int index, Vector2 position, std::string_view groundId);
+    Tile(const SaveFile& file, TileLayers& layers, int index, Vector2 position);
     void save(SaveFile& file) const;
     void exist();
-    void render(Window& window, bool fogOfWar, bool renderLight) const;
+    /// Renders the tile. If `staticLayerRendered` is true, the parts of the tile in the static layer
+    /// have already been rendered with renderStaticLayer.
+    void render(Window& window, bool fogOfWar, bool renderLight, bool staticLayerRendered = false) const;
+    /// Returns true if the ground, liquids and object of this tile can be rendered from the static
+    /// layer, i.e. none of them are animated and there are no items to render between them.
+    bool hasStaticAppearance() const;
+    /// Redraws this tile to the static layer of its area if it has changed since last time.
+    void updateStaticLayer(Window& window) const;
+    /// Renders this tile and the `count - 1` tiles to its right from the static layer in one blit.
+    /// The tiles must be in the same area, have a static appearance and be up to date.
+    void renderStaticLayer(Window& window, int count) const;
     Creature* spawnCreature(std::string_view id, std::unique_ptr<Controller> controller = nullptr);
     Creature* spawnCreature(const SaveFile& file);
-    bool hasCreature() const { return creature != nullptr; }
-    Creature* getCreature() const { return creature; }
-    void setCreature(Creature* creature) { this->creature = creature; }
+    bool hasCreature() const { return getCreature() != nullptr; }
+    Creature* getCreature() const { return layers.creatures[index]; }
+    void setCreature(Creature* creature);
     void removeCreature();
-    bool hasItems() const { return !items.empty(); }
-    const std::vector<std::unique_ptr<Item>>& getItems() const { return items; }
+    bool hasItems() const { return layers.items.count(index) != 0; }
+    const std::vector<std::unique_ptr<Item>>& getItems() const;
     std::unique_ptr<Item> removeTopmostItem();
     void addItem(std::unique_ptr<Item> item);
     void addLiquid(std::string_view materialId);
-    bool hasObject() const { return object != nullptr; }
-    Object* getObject() { return object.get(); }
-    const Object* getObject() const { return object.get(); }
+    bool hasObject() const { return getObject() != nullptr; }
+    Object* getObject() { return layers.objects[index].get(); }
+    const Object* getObject() const { return layers.objects[index].get(); }
     void setObject(std::unique_ptr<Object>);
-    std::string_view getGroundId() const { return groundId; }
+    std::string_view getGroundId() const;
     void setGround(std::string_view groundId);
     std::vector<Entity*> getEntities() const;
+    template<typename Function>
+    void forEachEntity(Function function) const;
+    bool hasLightSources() const;
     std::vector<LightSource*> getLightSources() const;
-    Color getLight() const { return light; }
-    void emitLight();
-    void addLight(Color light) { this->light.lighten(light); }
-    void resetLight();
-    bool blocksSight() const;
+    Color getLight() const { return layers.lights[index]; }
+    bool blocksSight() const { return layers.sightBlocking[index]; }
+    /// Must be called when the object on this tile changes its appearance or starts or stops
+    /// blocking sight.
+    void onObjectChanged();
+    /// Must be called when anything drawn on this tile changes, so that the tile gets redrawn.
+    void markChanged();
     Tile* getAdjacentTile(Dir8) const;
     Tile* getPreExistingAdjacentTile(Dir8) const;
     Tile* getTileBelow() const;
     Tile* getTileAbove() const;
-    World& getWorld() const { return world; }
+    World& getWorld() const { return layers.world; }
     Vector2 getPosition() const { return position; }
-    Vector3 getPosition3D() const { return Vector3(position) + Vector3(0, 0, level); }
-    int getLevel() const { return level; }
+    Vector3 getPosition3D() const { return Vector3(position) + Vector3(0, 0, getLevel()); }
+    int getLevel() const { return layers.level; }
     Vector2 getCenterPosition() const { return position * getSize() + getSize() / 2; }
     std::string getTooltip() const;
     static Vector2 getSize();
     static const Vector2 spriteSize;
 
 private:
-    Creature* creature = nullptr;
-    std::vector<std::unique_ptr<Item>> items;
-    std::vector<Liquid> liquids;
-    std::unique_ptr<Object> object;
-    World& world;
+    void renderGroundAndLiquids(Window& window, Vector2 renderPosition) const;
+    void invalidateStaticLayer() { layers.staticLayerDirty[index] = true; markChanged(); }
+    void setActive(bool active);
+    Vector2 getStaticLayerPosition() const;
+
+    TileLayers& layers;
     Vector2 position;
-    int level;
-    std::string groundId;
-    Sprite groundSprite;
-    Color light;
+    int index;
 };
+
+template<typename Function>
+void Tile::forEachEntity(Function function) const
+{
+    if (auto* creature = getCreature())
+    {
+        function(*creature);
+
+        for (auto* item : creature->getEquipment())
+            if (item)
+                function(*item);
+    }
+
+    for (auto& item : getItems())
+        function(*item);
+
+    if (auto* object = layers.objects[index].get())
+        function(*object);
+}
@@ -0,0 +1,119 @@
+#include "tilememory.h"
+#include "area.h"
+#include "world.h"
+#include "engine/savefile.h"
+#include <stdexcept>
+
+static const int bitsPerWord = 64;
+static const int bitmapSize = Area::size * Area::size;
+
+TileMemory::TileMemory(const SaveFile& file)
+{
+    // Each bitmap is stored as the lengths of its alternating runs of unset and set bits.
+    auto bitmapCount = file.readInt32();
+    bitmaps.reserve(size_t(bitmapCount));
+
+    for (int i = 0; i < bitmapCount; ++i)
+    {
+        auto& bitmap = bitmaps[file.readVector3()];
+        bitmap.resize(bitmapSize / bitsPerWord);
+        auto runCount = file.readUint16();
+        int index = 0;
+
+        for (int run = 0; run < runCount; ++run)
+        {
+            int runEnd = index + file.readUint16();
+
+            if (runEnd > bitmapSize)
+                throw std::runtime_error("Invalid tile memory in save file");
+
+            if (run % 2 == 1)
+            {
+                for (; index < runEnd; ++index)
+                    bitmap[index / bitsPerWord] |= uint64_t(1) << (index % bitsPerWord);
+            }
+
+            index = runEnd;
+        }
+    }
+}
+
+void TileMemory::save(SaveFile& file) const
+{
+    file.writeInt32(uint32_t(bitmaps.size()));
+    std::vector<uint16_t> runs;
+
+    for (auto& [areaPosition, bitmap] : bitmaps)
+    {
+        runs.clear();
+        bool runValue = false;
+        int runStart = 0;
+
+        for (int index = 0; index < bitmapSize; ++index)
+        {
+            bool value = (bitmap[index / bitsPerWord] >> (index % bitsPerWord)) & 1;
+
+            if (value != runValue)
+            {
+                runs.push_back(uint16_t(index - runStart));
+                runValue = value;
+                runStart = index;
+            }
+        }
+
+        runs.push_back(uint16_t(bitmapSize - runStart));
+
+        file.write(areaPosition);
+        file.writeInt16(uint16_t(runs.size()));
+        for (auto run : runs)
+            file.writeInt16(run);
+    }
+}
+
+void TileMemory::add(Vector3 position)
+{
+    auto areaPosition = World::globalPositionToAreaPosition(Vector2(position), position.z);
+    auto* bitmap = getBitmap(areaPosition);
+
+    if (!bitmap)
+    {
+        bitmap = &bitmaps.emplace(areaPosition, Bitmap(bitmapSize / bitsPerWord)).first->second;
+        lastAreaPosition = areaPosition;
+        lastBitmap = bitmap;
+    }
+
+    auto index = getBitIndex(position);
+    (*bitmap)[index / bitsPerWord] |= uint64_t(1) << (index % bitsPerWord);
+}
+
+bool TileMemory::contains(Vector3 position)
+{
+    auto* bitmap = getBitmap(World::globalPositionToAreaPosition(Vector2(position), position.z));
+
+    if (!bitmap)
+        return false;
+
+    auto index = getBitIndex(position);
+    return ((*bitmap)[index / bitsPerWord] >> (index % bitsPerWord)) & 1;
+}
+
+TileMemory::Bitmap* TileMemory::getBitmap(Vector3 areaPosition)
+{
+    if (lastBitmap && areaPosition == lastAreaPosition)
+        return lastBitmap;
+
+    auto it = bitmaps.find(areaPosition);
+
+    if (it == bitmaps.end())
+        return nullptr;
+
+    lastAreaPosition = areaPosition;
+    lastBitmap = &it->second;
+    return lastBitmap;
+}
+
+int TileMemory::getBitIndex(Vector3 position)
+{
+    auto tilePosition = World::globalPositionToTilePosition(Vector2(position));
+    return tilePosition.y * Area::size + tilePosition.x;
+}
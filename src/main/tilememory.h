@@ -0,0 +1,34 @@
+#pragma once
+
+#include "engine/geometry.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class SaveFile;
+
+/// The set of tiles a creature has seen, stored as a bitmap per area. The bitmap of an area is
+/// allocated when the first tile in it is added.
+class TileMemory
+{
+public:
+    TileMemory() = default;
+    explicit TileMemory(const SaveFile& file);
+    TileMemory(TileMemory&&) = default;
+    TileMemory& operator=(TileMemory&&) = default;
+    void save(SaveFile& file) const;
+    void add(Vector3 position);
+    /// Not const, as it caches the bitmap it looks up.
+    bool contains(Vector3 position);
+
+private:
+    using Bitmap = std::vector<uint64_t>;
+
+    Bitmap* getBitmap(Vector3 areaPosition);
+    static int getBitIndex(Vector3 position);
+
+    std::unordered_map<Vector3, Bitmap> bitmaps;
+    /// The most recently used bitmap, as consecutive queries tend to fall in the same area.
+    Vector3 lastAreaPosition;
+    Bitmap* lastBitmap = nullptr;
+};
@@ -4,43 +4,124 @@
 #include "worldgen.h"
 #include "components/lightsource.h"
 #include "engine/assert.h"
+#include "engine/math.h"
 #include "engine/savefile.h"
+#include <algorithm>
+#include <chrono>
+#include <optional>
 
-void World::load(SaveFile& file)
+thread_local World::GeneratedArea* World::areaBeingGenerated = nullptr;
+
+void World::load(SaveFile file)
 {
+    seed = RNG::result_type(file.readInt64());
+    simulationStep = file.readUint64();
     auto areaCount = file.readInt32();
-    areas.reserve(size_t(areaCount));
+    std::vector<std::pair<int64_t, Vector3>> areaOffsets;
+    areaOffsets.reserve(size_t(areaCount));
+
     for (int i = 0; i < areaCount; ++i)
     {
         auto position = file.readVector3();
         auto offset = file.readInt64();
-        savedAreaOffsets.emplace(position, offset);
+        areaOffsets.emplace_back(offset, position);
+    }
+
+    // The areas are stored back to back at the end of the file. They're read from the file only when
+    // they're needed, so only the index is touched here.
+    std::sort(areaOffsets.begin(), areaOffsets.end(), [](auto& a, auto& b) { return a.first < b.first; });
+
+    for (size_t i = 0; i < areaOffsets.size(); ++i)
+    {
+        auto end = i + 1 < areaOffsets.size() ? areaOffsets[i + 1].first : int64_t(file.getSize());
+        savedAreas.emplace(areaOffsets[i].second, std::make_pair(areaOffsets[i].first, size_t(end - areaOffsets[i].first)));
     }
 
-    saveFile = std::make_unique<SaveFile>(file.copyToMemory());
+    saveFile = std::make_unique<SaveFile>(std::move(file));
 }
 
-void World::save(SaveFile& file) const
+void World::releaseSaveFile()
 {
-    file.writeInt32(int32_t(areas.size()));
-    auto areaPositionsOffset = file.getOffset();
+    for (auto& [position, offsetAndSize] : savedAreas)
+        areaPager.store(position, readSavedArea(offsetAndSize));
+
+    savedAreas.clear();
+    saveFile = nullptr;
+}
+
+void World::switchSaveFile(SaveFile file)
+{
+    savedAreas = std::move(savedAreasInNewFile);
+    savedAreasInNewFile.clear();
+    saveFile = std::make_unique<SaveFile>(std::move(file));
+}
+
+std::vector<char> World::readSavedArea(std::pair<int64_t, size_t> offsetAndSize) const
+{
+    std::vector<char> data(offsetAndSize.second);
+    saveFile->seek(offsetAndSize.first);
+    saveFile->readBytes(data.data(), data.size());
+    return data;
+}
+
+void World::save(SaveFile& file)
+{
+    std::vector<Vector3> areaPositions;
+    std::vector<Area*> residentAreas;
 
     for (auto& positionAndArea : areas)
     {
-        file.write(positionAndArea.first);
-        file.writeInt64(int64_t(0));
+        areaPositions.push_back(positionAndArea.first);
+        residentAreas.push_back(&positionAndArea.second);
     }
 
-    int index = 0;
-    for (auto& positionAndArea : areas)
+    for (auto& positionAndSavedArea : savedAreas)
+        areaPositions.push_back(positionAndSavedArea.first);
+
+    auto pagedAreaPositions = areaPager.getAreaPositions();
+    areaPositions.insert(areaPositions.end(), pagedAreaPositions.begin(), pagedAreaPositions.end());
+
+    // Serialize each resident area into its own buffer in parallel. Areas that aren't resident are
+    // already serialized, so their bytes are copied as they are.
+    std::vector<std::vector<char>> areaData(areaPositions.size());
+
+    forEachArea(residentAreas.size(), [&](size_t index)
     {
-        auto areaOffset = file.getOffset();
-        file.seek(areaPositionsOffset + index * (sizeof(Vector3) + sizeof(int64_t)) + sizeof(Vector3));
-        file.writeInt64(areaOffset);
-        file.seek(areaOffset);
-        positionAndArea.second.save(file);
-        ++index;
+        SaveFile buffer;
+        residentAreas[index]->save(buffer);
+        areaData[index] = buffer.takeBuffer();
+    });
+
+    for (size_t index = residentAreas.size(); index < areaPositions.size(); ++index)
+    {
+        auto savedArea = savedAreas.find(areaPositions[index]);
+        areaData[index] = savedArea != savedAreas.end() ? readSavedArea(savedArea->second) : areaPager.read(areaPositions[index]);
     }
+
+    // The sizes of the areas are known up front, so the whole index is written at once.
+    SaveFile header;
+    header.writeInt64(int64_t(seed));
+    header.writeInt64(simulationStep);
+    header.writeInt32(int32_t(areaPositions.size()));
+    auto areaOffset = file.getOffset() + int64_t(header.getOffset() + areaPositions.size() * (sizeof(Vector3) + sizeof(int64_t)));
+    savedAreasInNewFile.clear();
+
+    for (size_t index = 0; index < areaPositions.size(); ++index)
+    {
+        header.write(areaPositions[index]);
+        header.writeInt64(areaOffset);
+
+        if (savedAreas.count(areaPositions[index]))
+            savedAreasInNewFile.emplace(areaPositions[index], std::make_pair(areaOffset, areaData[index].size()));
+
+        areaOffset += int64_t(areaData[index].size());
+    }
+
+    auto headerData = header.takeBuffer();
+    file.writeBytes(headerData.data(), headerData.size());
+
+    for (auto& data : areaData)
+        file.writeBytes(data.data(), data.size());
 }
 
 int World::getTurn() const
@@ -48,40 +129,416 @@ int World::getTurn() const
     return game->gameState->turn;
 }
 
+enum RandomStream
+{
+    TileStream,
+    CreatureStream,
+    GenerationStream
+};
+
+static RNG getAreaRNG(RNG::result_type seed, Vector3 areaPosition, RandomStream stream)
+{
+    std::seed_seq seeds { seed, RNG::result_type(areaPosition.x), RNG::result_type(areaPosition.y),
+                          RNG::result_type(areaPosition.z), RNG::result_type(stream) };
+    return RNG(seeds);
+}
+
 void World::exist(Rect region, int level)
 {
-    for (auto* tile : getTiles(region, level))
-        tile->exist();
+    updateLight();
+
+    // Each area draws random numbers from its own stream, so that the outcome doesn't depend on the
+    // number of threads or the order in which the areas are processed.
+    auto turnSeed = rng();
+    ++simulationStep;
+    auto* player = game->getPlayer();
+    auto playerAreaPosition = globalPositionToAreaPosition(player->getPosition(), player->getLevel());
+
+    // Missing areas aren't generated here, but in the background ahead of time, or on demand when a
+    // creature on the main thread steps into one. Start before the player's turn waits for input.
+    generateAreasAhead(playerAreaPosition);
+    auto regionAreas = getExistingAreas(region, level);
+
+    auto existTiles = [&](Area& area)
+    {
+        ScopedRNG scopedRNG(getAreaRNG(turnSeed, Vector3(area.position) + Vector3(0, 0, area.level), TileStream));
+        Rect areaRegion(area.position * Area::sizeVector, Area::sizeVector);
+        int left = std::max(region.getLeft(), areaRegion.getLeft());
+        int right = std::min(region.getRight(), areaRegion.getRight());
+        int top = std::max(region.getTop(), areaRegion.getTop());
+        int bottom = std::min(region.getBottom(), areaRegion.getBottom());
+
+        if (left > right)
+            return;
+
+        static_assert(Area::size == 64, "each row of an area must be one word of the active tile bitmap");
+        uint64_t columnMask = (~uint64_t(0) >> (63 - (right - left))) << (left - areaRegion.getLeft());
+
+        // Only tiles with liquids or active items do anything, so visit just those, in row-major order.
+        for (int y = top; y <= bottom; ++y)
+        {
+            int row = y - areaRegion.getTop();
+
+            for (uint64_t activeTiles = area.layers->activeTiles[size_t(row)] & columnMask; activeTiles; activeTiles &= activeTiles - 1)
+                area.tiles[size_t(row * Area::size + countTrailingZeros(activeTiles))].exist();
+        }
+    };
+
+    auto existCreatures = [&](Area& area, const std::vector<Creature*>& areaCreatures)
+    {
+        ScopedRNG scopedRNG(getAreaRNG(turnSeed, Vector3(area.position) + Vector3(0, 0, area.level), CreatureStream));
+
+        for (auto* creature : areaCreatures)
+        {
+            if (!creature->isDead())
+                creature->exist();
+        }
+    };
 
-    for (int i = 0, size = creatures.size(); i < size; ++i)
+    // The player's area is updated first on the main thread, as the player's turn waits for input.
+    auto isPlayerArea = [&](const Area& area)
     {
-        if (auto creature = &*creatures[i])
-            creature->exist();
+        return Vector3(area.position) + Vector3(0, 0, area.level) == playerAreaPosition;
+    };
+
+    for (auto* area : regionAreas)
+    {
+        if (isPlayerArea(*area))
+            existTiles(*area);
     }
 
+    regionAreas.erase(std::remove_if(regionAreas.begin(), regionAreas.end(), [&](Area* area) { return isPlayerArea(*area); }),
+                      regionAreas.end());
+    areasAreFrozen = true;
+    forEachArea(regionAreas.size(), [&](size_t index) { existTiles(*regionAreas[index]); });
+    areasAreFrozen = false;
+
+    // Creatures only affect their own area and the areas adjacent to it, so areas that are at least
+    // two areas apart from each other can be updated simultaneously.
+    std::vector<std::pair<Area*, std::vector<Creature*>>> batches[simulationBatchStride * simulationBatchStride];
+    std::pair<Area*, std::vector<Creature*>> playerArea(nullptr, {});
+
+    // Only the creatures near the player are updated, so the cost of a turn doesn't grow with the
+    // number of areas in memory. The creatures elsewhere are parked, and catch up on the turns they
+    // missed once they're near the player again.
+    for (int dy = -simulationDistance; dy <= simulationDistance; ++dy)
+    {
+        for (int dx = -simulationDistance; dx <= simulationDistance; ++dx)
+        {
+            auto* areaPointer = getResidentArea(playerAreaPosition + Vector3(dx, dy, 0));
+
+            if (!areaPointer)
+                continue;
+
+            auto& area = *areaPointer;
+
+            if (area.lastSimulatedStep + 1 < simulationStep)
+            {
+                for (auto* creature : area.creatures)
+                    creature->catchUp(int(simulationStep - area.lastSimulatedStep - 1));
+            }
+
+            area.lastSimulatedStep = simulationStep;
+
+            if (area.creatures.empty())
+                continue;
+
+            if (isPlayerArea(area))
+            {
+                playerArea = { &area, area.creatures };
+                continue;
+            }
+
+            int batchX = (area.position.x % simulationBatchStride + simulationBatchStride) % simulationBatchStride;
+            int batchY = (area.position.y % simulationBatchStride + simulationBatchStride) % simulationBatchStride;
+            batches[batchY * simulationBatchStride + batchX].emplace_back(&area, area.creatures);
+        }
+    }
+
+    if (playerArea.first)
+        existCreatures(*playerArea.first, playerArea.second);
+
+    areasAreFrozen = true;
+
+    for (auto& batch : batches)
+        forEachArea(batch.size(), [&](size_t index) { existCreatures(*batch[index].first, batch[index].second); });
+
+    areasAreFrozen = false;
+    pageAreas(playerAreaPosition);
     creatures.erase(std::remove(creatures.begin(), creatures.end(), nullptr), creatures.end());
 }
 
-void World::render(Window& window, Rect region, int level, const Creature& player)
+bool World::installGeneratedAreas()
+{
+    for (auto it = pendingAreas.begin(); it != pendingAreas.end();)
+    {
+        if (it->second.second.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            ++it;
+            continue;
+        }
+
+        auto position = it->first;
+        auto generatedArea = std::move(it->second.first);
+        auto future = std::move(it->second.second);
+        it = pendingAreas.erase(it);
+        future.get();
+        installArea(position, *generatedArea);
+    }
+
+    return !pendingAreas.empty();
+}
+
+void World::generateAreasAhead(Vector3 centerAreaPosition)
 {
-    auto tiles = getTiles(region, level);
+    installGeneratedAreas();
 
-    for (auto* tile : tiles)
-        tile->resetLight();
+    std::vector<Vector2> offsets;
 
-    // Handle light sources outside the current region emitting light into the current region.
-    auto emitRegion = region.inset(Vector2(-LightSource::maxRadius, -LightSource::maxRadius));
+    for (int dy = -pagingDistance; dy <= pagingDistance; ++dy)
+    {
+        for (int dx = -pagingDistance; dx <= pagingDistance; ++dx)
+            offsets.emplace_back(dx, dy);
+    }
 
-    for (auto* tile : getTiles(emitRegion, level))
-        tile->emitLight();
+    // The closest areas are the most likely to be needed soon.
+    std::stable_sort(offsets.begin(), offsets.end(), [](Vector2 a, Vector2 b) { return a.getLengthSquared() < b.getLengthSquared(); });
 
-    for (auto* tile : tiles)
+    for (auto offset : offsets)
     {
+        if (pendingAreas.size() >= maxPendingAreas)
+            break;
+
+        auto position = centerAreaPosition + Vector3(offset);
+        auto positionAbove = position + Vector3(0, 0, 1);
+
+        // The StairsDown in the area above must be known before generating the area.
+        if (areaExists(position) || (position.z < 0 && !getResidentArea(positionAbove)))
+            continue;
+
+        auto generatedArea = prepareArea(position);
+        auto future = generationQueue.submit([this, position, generatedArea]
+        {
+            if (!generatedArea->isClaimed.exchange(true))
+                generateArea(position, *generatedArea);
+        });
+        pendingAreas.emplace(position, std::make_pair(std::move(generatedArea), std::move(future)));
+    }
+}
+
+std::shared_ptr<World::GeneratedArea> World::prepareArea(Vector3 position)
+{
+    auto generatedArea = std::make_shared<GeneratedArea>();
+
+    // Underground areas connect to the area above, which is therefore generated first.
+    if (auto* areaAbove = position.z < 0 ? getOrCreateArea(position + Vector3(0, 0, 1)) : nullptr)
+    {
+        for (auto& tile : areaAbove->tiles)
+        {
+            if (tile.hasObject() && tile.getObject()->getId() == "StairsDown")
+                generatedArea->stairsDownAbove.push_back(tile.getPosition());
+        }
+    }
+
+    return generatedArea;
+}
+
+void World::generateArea(Vector3 position, GeneratedArea& generatedArea)
+{
+    struct GenerationScope
+    {
+        GenerationScope(GeneratedArea& generatedArea) { areaBeingGenerated = &generatedArea; }
+        ~GenerationScope() { areaBeingGenerated = nullptr; }
+    };
+
+    GenerationScope generationScope(generatedArea);
+    generatedArea.area = std::make_unique<Area>(*this, Vector2(position), position.z);
+    WorldGenerator generator(*generatedArea.area, std::move(generatedArea.stairsDownAbove),
+                             getAreaRNG(seed, position, GenerationStream));
+    generator.generateArea();
+    generatedArea.removedStairsDown = std::move(generator.removedStairsDown);
+}
+
+Area& World::installArea(Vector3 position, GeneratedArea& generatedArea)
+{
+    auto& area = areas.emplace(position, std::move(*generatedArea.area)).first->second;
+    // A new area has no turns to catch up on. Areas loaded from the pager or the save file keep the
+    // step they were last simulated in, so they catch up on the turns they spent paged out.
+    area.lastSimulatedStep = simulationStep;
+
+    for (auto& creature : generatedArea.creatures)
+        addCreature(std::move(creature));
+
+    if (!generatedArea.removedStairsDown.empty())
+    {
+        if (auto* areaAbove = getArea(position + Vector3(0, 0, 1)))
+        {
+            for (auto stairsPosition : generatedArea.removedStairsDown)
+            {
+                auto& tile = areaAbove->getTileAt(globalPositionToTilePosition(stairsPosition));
+
+                if (tile.hasObject() && tile.getObject()->getId() == "StairsDown")
+                    tile.setObject(nullptr);
+            }
+        }
+    }
+
+    onAreaCreated(area);
+    return area;
+}
+
+bool World::areaExists(Vector3 position) const
+{
+    return areas.count(position) || savedAreas.count(position) || areaPager.contains(position)
+        || pendingAreas.count(position);
+}
+
+void World::pageAreas(Vector3 centerAreaPosition)
+{
+    ++pagingClock;
+    std::vector<Vector3> areasToPrefetch;
+
+    auto touch = [&](Vector3 position)
+    {
+        if (auto* area = getResidentArea(position))
+            area->lastUsed = pagingClock;
+        else if (savedAreas.find(position) == savedAreas.end() && areaPager.contains(position))
+            areasToPrefetch.push_back(position);
+    };
+
+    for (int dy = -pagingDistance; dy <= pagingDistance; ++dy)
+    {
+        for (int dx = -pagingDistance; dx <= pagingDistance; ++dx)
+            touch(centerAreaPosition + Vector3(dx, dy, 0));
+    }
+
+    // The player may take the stairs.
+    touch(centerAreaPosition + Vector3(0, 0, 1));
+    touch(centerAreaPosition + Vector3(0, 0, -1));
+    areaPager.prefetch(areasToPrefetch);
+
+    if (areas.size() <= size_t(maxResidentAreas))
+        return;
+
+    std::vector<std::pair<uint64_t, Vector3>> areasToEvict;
+
+    for (auto& positionAndArea : areas)
+    {
+        if (positionAndArea.second.lastUsed != pagingClock)
+            areasToEvict.emplace_back(positionAndArea.second.lastUsed, positionAndArea.first);
+    }
+
+    std::sort(areasToEvict.begin(), areasToEvict.end(), [](auto& a, auto& b) { return a.first < b.first; });
+
+    for (auto& lastUsedAndPosition : areasToEvict)
+    {
+        if (areas.size() <= size_t(maxResidentAreas))
+            break;
+
+        evictArea(lastUsedAndPosition.second);
+    }
+}
+
+void World::evictArea(Vector3 position)
+{
+    auto it = areas.find(position);
+    ASSERT(it != areas.end());
+    auto& area = it->second;
+
+    SaveFile file;
+    area.save(file);
+    areaPager.store(position, file.takeBuffer());
+
+    // The creatures are saved with the area, and recreated when it's loaded again.
+    for (auto* creature : area.creatures)
+        removeCreature(creature);
+
+    Rect region(area.position * Area::sizeVector, Area::sizeVector);
+    auto maxRadius = Vector2(LightSource::maxRadius, LightSource::maxRadius);
+    areas.erase(it);
+
+    // Light sources in the evicted area no longer light up the neighboring areas.
+    regionsToRelight.emplace_back(region.inset(-maxRadius), position.z);
+    ++sightVersion;
+}
+
+void World::forEachArea(size_t count, const std::function<void(size_t)>& task)
+{
+    if (isSimulationParallel)
+    {
+        threadPool.forEach(count, task);
+        return;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+        task(i);
+}
+
+void World::render(Window& window, Rect region, int level, const Creature& player)
+{
+    updateLight();
+
+    struct VisibleTile
+    {
+        Tile* tile;
+        bool fogOfWar;
+        bool hasStaticAppearance;
+    };
+
+    std::vector<VisibleTile> visibleTiles;
+
+    for (auto* tile : getTiles(region, level))
+    {
+        if (!window.context.isDirty(Rect(tile->getPosition() * Tile::getSize(), Tile::getSize())))
+            continue;
+
         bool sees = game->playerSeesEverything || player.sees(*tile);
         bool fogOfWar = !sees && player.remembers(*tile);
 
-        if (sees || fogOfWar)
-            tile->render(window, fogOfWar, !game->playerSeesEverything);
+        if (!sees && !fogOfWar)
+            continue;
+
+        bool hasStaticAppearance = tile->hasStaticAppearance();
+
+        if (hasStaticAppearance)
+            tile->updateStaticLayer(window);
+
+        visibleTiles.push_back({ tile, fogOfWar, hasStaticAppearance });
+    }
+
+    // Render the static layers of horizontally adjacent tiles in the same area with one blit.
+    for (auto run = visibleTiles.begin(); run != visibleTiles.end();)
+    {
+        if (!run->hasStaticAppearance)
+        {
+            ++run;
+            continue;
+        }
+
+        auto runEnd = run + 1;
+
+        while (runEnd != visibleTiles.end() && runEnd->hasStaticAppearance
+               && runEnd->tile->getPosition() == (runEnd - 1)->tile->getPosition() + Vector2(1, 0)
+               && globalPositionToTilePosition(runEnd->tile->getPosition()).x != 0)
+            ++runEnd;
+
+        run->tile->renderStaticLayer(window, int(runEnd - run));
+        run = runEnd;
+    }
+
+    for (auto& visibleTile : visibleTiles)
+        visibleTile.tile->render(window, visibleTile.fogOfWar, !game->playerSeesEverything, visibleTile.hasStaticAppearance);
+
+    // Static layers are only kept for the areas being rendered.
+    for (auto& area : areas)
+    {
+        auto areaRegion = area.second.getRegion();
+        bool isRendered = area.second.level == level
+            && areaRegion.getLeft() <= region.getRight() && areaRegion.getRight() >= region.getLeft()
+            && areaRegion.getTop() <= region.getBottom() && areaRegion.getBottom() >= region.getTop();
+
+        if (!isRendered)
+            area.second.layers->staticLayer.reset();
     }
 }
 
@@ -90,26 +547,96 @@ Area* World::getOrCreateArea(Vector3 position)
     if (auto* area = getArea(position))
         return area;
 
-    auto& area = areas.emplace(position, Area(*this, Vector2(position), position.z)).first->second;
-    WorldGenerator generator(*this);
-    generator.generateRegion(Rect(Vector2(position) * Area::sizeVector, Area::sizeVector), position.z);
-    return &area;
+    if (areasAreFrozen)
+        return nullptr;
+
+    auto pendingArea = pendingAreas.find(position);
+
+    if (pendingArea != pendingAreas.end())
+    {
+        auto generatedArea = std::move(pendingArea->second.first);
+        auto future = std::move(pendingArea->second.second);
+        pendingAreas.erase(pendingArea);
+
+        // Generate the area right away unless a worker has already started on it.
+        if (!generatedArea->isClaimed.exchange(true))
+            generateArea(position, *generatedArea);
+        else
+            future.get();
+
+        return &installArea(position, *generatedArea);
+    }
+
+    auto generatedArea = prepareArea(position);
+    generatedArea->isClaimed = true;
+    generateArea(position, *generatedArea);
+    return &installArea(position, *generatedArea);
 }
 
 Area* World::getArea(Vector3 position)
+{
+    if (auto* area = getResidentArea(position))
+        return area;
+
+    if (areasAreFrozen)
+        return nullptr;
+
+    Area* area;
+    auto savedArea = savedAreas.find(position);
+
+    if (savedArea != savedAreas.end())
+    {
+        saveFile->seek(savedArea->second.first);
+        area = &areas.emplace(position, Area(*saveFile, *this, Vector2(position), position.z)).first->second;
+        savedAreas.erase(savedArea);
+    }
+    else if (areaPager.contains(position))
+    {
+        SaveFile file(areaPager.take(position));
+        area = &areas.emplace(position, Area(file, *this, Vector2(position), position.z)).first->second;
+    }
+    else
+    {
+        // An area that has finished generating in the background can be added without waiting.
+        auto pendingArea = pendingAreas.find(position);
+
+        if (pendingArea == pendingAreas.end()
+            || pendingArea->second.second.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            return nullptr;
+
+        auto generatedArea = std::move(pendingArea->second.first);
+        auto future = std::move(pendingArea->second.second);
+        pendingAreas.erase(pendingArea);
+        future.get();
+        return &installArea(position, *generatedArea);
+    }
+
+    onAreaCreated(*area);
+    return area;
+}
+
+Area* World::getResidentArea(Vector3 position)
 {
     auto it = areas.find(position);
-    if (it != areas.end())
-        return &it->second;
+    return it != areas.end() ? &it->second : nullptr;
+}
 
-    auto offset = savedAreaOffsets.find(position);
-    if (offset != savedAreaOffsets.end())
+std::vector<Area*> World::getExistingAreas(Rect region, int level)
+{
+    std::vector<Area*> existingAreas;
+    auto topLeft = globalPositionToAreaPosition(region.position, level);
+    auto bottomRight = globalPositionToAreaPosition(region.position + region.size - Vector2(1, 1), level);
+
+    for (int y = topLeft.y; y <= bottomRight.y; ++y)
     {
-        saveFile->seek(offset->second);
-        return &areas.emplace(position, Area(*saveFile, *this, Vector2(position), position.z)).first->second;
+        for (int x = topLeft.x; x <= bottomRight.x; ++x)
+        {
+            if (auto* area = getResidentArea(Vector3(x, y, level)))
+                existingAreas.push_back(area);
+        }
     }
 
-    return nullptr;
+    return existingAreas;
 }
 
 Vector3 World::globalPositionToAreaPosition(Vector2 position, int level)
@@ -141,13 +668,57 @@ Tile* World::getTile(Vector2 position, int level)
     return nullptr;
 }
 
+SightMap World::getSightMap(Rect region, int level)
+{
+    SightMap sightMap(region);
+    auto topLeft = globalPositionToAreaPosition(region.position, level);
+    auto bottomRight = globalPositionToAreaPosition(region.position + region.size - Vector2(1, 1), level);
+
+    for (int areaY = topLeft.y; areaY <= bottomRight.y; ++areaY)
+    {
+        for (int areaX = topLeft.x; areaX <= bottomRight.x; ++areaX)
+        {
+            auto* area = getArea(Vector3(areaX, areaY, level));
+
+            if (!area)
+                continue;
+
+            auto areaRegion = area->getRegion();
+            int left = std::max(region.getLeft(), areaRegion.getLeft());
+            int right = std::min(region.getRight(), areaRegion.getRight());
+            int top = std::max(region.getTop(), areaRegion.getTop());
+            int bottom = std::min(region.getBottom(), areaRegion.getBottom());
+
+            for (int y = top; y <= bottom; ++y)
+            {
+                int index = (y - areaRegion.getTop()) * Area::size + left - areaRegion.getLeft();
+
+                for (int x = left; x <= right; ++x, ++index)
+                {
+                    uint8_t flags = 0;
+
+                    if (area->layers->sightBlocking[index])
+                        flags |= SightMap::BlocksSight;
+
+                    if (area->layers->lights[index].getLuminance() < SightMap::darknessThreshold)
+                        flags |= SightMap::Dark;
+
+                    sightMap.setFlags(Vector2(x, y), flags);
+                }
+            }
+        }
+    }
+
+    return sightMap;
+}
+
 std::vector<Tile*> World::getTiles(Rect region, int level)
 {
     std::vector<Tile*> tiles;
     tiles.reserve(region.getArea());
 
     Area* currentArea = nullptr;
-    Vector3 currentAreaPosition;
+    std::optional<Vector3> currentAreaPosition;
 
     for (int y = region.getTop(); y <= region.getBottom(); ++y)
     {
@@ -156,15 +727,15 @@ std::vector<Tile*> World::getTiles(Rect region, int level)
             Vector2 position(x, y);
             Vector3 areaPosition = globalPositionToAreaPosition(position, level);
 
-            if (!currentArea || areaPosition != currentAreaPosition)
+            if (areaPosition != currentAreaPosition)
             {
-                currentArea = getOrCreateArea(areaPosition);
+                currentArea = getArea(areaPosition);
                 currentAreaPosition = areaPosition;
-
-                if (!currentArea)
-                    continue;
             }
 
+            if (!currentArea)
+                continue;
+
             tiles.push_back(&currentArea->getTileAt(globalPositionToTilePosition(position)));
         }
     }
@@ -174,12 +745,21 @@ std::vector<Tile*> World::getTiles(Rect region, int level)
 
 Creature* World::addCreature(std::unique_ptr<Creature> creature)
 {
+    if (areaBeingGenerated)
+    {
+        areaBeingGenerated->creatures.push_back(std::move(creature));
+        return areaBeingGenerated->creatures.back().get();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
     creatures.push_back(std::move(creature));
     return creatures.back().get();
 }
 
 std::unique_ptr<Creature> World::removeCreature(Creature* creature)
 {
+    std::lock_guard<std::mutex> lock(mutex);
+
     for (auto& c : creatures)
     {
         if (c.get() == creature)
@@ -188,3 +768,269 @@ std::unique_ptr<Creature> World::removeCreature(Creature* creature)
 
     ASSERT(false);
 }
+
+std::vector<Creature*> World::getCreatures(Rect region, int level) const
+{
+    std::vector<Creature*> creaturesInRegion;
+    auto topLeft = globalPositionToAreaPosition(region.position, level);
+    auto bottomRight = globalPositionToAreaPosition(region.position + region.size - Vector2(1, 1), level);
+
+    for (int y = topLeft.y; y <= bottomRight.y; ++y)
+    {
+        for (int x = topLeft.x; x <= bottomRight.x; ++x)
+        {
+            auto it = areas.find(Vector3(x, y, level));
+
+            if (it == areas.end())
+                continue;
+
+            for (auto* creature : it->second.creatures)
+            {
+                if (creature->getPosition().isWithin(region))
+                    creaturesInRegion.push_back(creature);
+            }
+        }
+    }
+
+    return creaturesInRegion;
+}
+
+void World::onCreatureEntered(Tile& tile)
+{
+    if (areaBeingGenerated)
+        return;
+
+    // Areas that are still being constructed are indexed as a whole in onAreaCreated.
+    auto it = areas.find(globalPositionToAreaPosition(tile.getPosition(), tile.getLevel()));
+
+    if (it != areas.end())
+        it->second.creatures.push_back(tile.getCreature());
+}
+
+void World::onCreatureLeft(Tile& tile)
+{
+    if (areaBeingGenerated)
+        return;
+
+    auto it = areas.find(globalPositionToAreaPosition(tile.getPosition(), tile.getLevel()));
+
+    if (it == areas.end())
+        return;
+
+    auto& areaCreatures = it->second.creatures;
+    auto creature = std::find(areaCreatures.begin(), areaCreatures.end(), tile.getCreature());
+
+    if (creature != areaCreatures.end())
+        areaCreatures.erase(creature);
+}
+
+void World::invalidateLightSources(Vector2 position, int level)
+{
+    if (areaBeingGenerated)
+        return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    lightSourceChanges.push_back(Vector3(position) + Vector3(0, 0, level));
+}
+
+void World::invalidateSightBlocking(Vector2 position, int level)
+{
+    if (areaBeingGenerated)
+        return;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    sightBlockingChanges.push_back(Vector3(position) + Vector3(0, 0, level));
+    lock.unlock();
+
+    auto it = areas.find(globalPositionToAreaPosition(position, level));
+    if (it != areas.end())
+        onSightChanged(it->second);
+}
+
+uint64_t World::getSightVersion(Vector3 areaPosition) const
+{
+    auto it = areas.find(areaPosition);
+    return it != areas.end() ? it->second.sightVersion : 0;
+}
+
+void World::onSightChanged(Area& area)
+{
+    area.sightVersion = ++sightVersion;
+}
+
+void World::onAreaCreated(Area& area)
+{
+    Rect region(area.position * Area::sizeVector, Area::sizeVector);
+    area.creatures.clear();
+
+    for (auto& tile : area.tiles)
+    {
+        if (tile.hasCreature())
+            area.creatures.push_back(tile.getCreature());
+
+        if (tile.hasLightSources())
+            invalidateLightSources(tile.getPosition(), area.level);
+    }
+
+    // Light sources in neighboring areas may now reach further than before.
+    auto neighborRegion = region.inset(Vector2(-LightSource::maxRadius, -LightSource::maxRadius));
+
+    for (auto* neighbor : getExistingAreas(neighborRegion, area.level))
+    {
+        for (auto& positionAndEmitter : neighbor->lightEmitters)
+        {
+            positionAndEmitter.second.isDirty = true;
+            invalidateLightSources(positionAndEmitter.first, area.level);
+        }
+    }
+
+    regionsToRelight.emplace_back(region, area.level);
+    onSightChanged(area);
+    area.lastUsed = pagingClock;
+
+    // Draw the whole area once it's in view, even if it's added between turns.
+    std::fill(area.layers->changedTiles.begin(), area.layers->changedTiles.end(), ~uint64_t(0));
+}
+
+void World::updateLight()
+{
+    std::vector<Area*> areasWithDirtyEmitters;
+
+    auto markDirty = [&](Area& area, LightEmitter& emitter)
+    {
+        emitter.isDirty = true;
+
+        if (std::find(areasWithDirtyEmitters.begin(), areasWithDirtyEmitters.end(), &area) == areasWithDirtyEmitters.end())
+            areasWithDirtyEmitters.push_back(&area);
+    };
+
+    for (auto position : lightSourceChanges)
+    {
+        auto* area = getResidentArea(globalPositionToAreaPosition(Vector2(position), position.z));
+
+        if (!area)
+            continue;
+
+        auto& tile = area->getTileAt(globalPositionToTilePosition(Vector2(position)));
+        auto lightSources = tile.getLightSources();
+        auto it = area->lightEmitters.find(Vector2(position));
+
+        if (lightSources.empty())
+        {
+            if (it != area->lightEmitters.end())
+            {
+                regionsToRelight.emplace_back(it->second.getRegion(), position.z);
+                area->lightEmitters.erase(it);
+            }
+
+            continue;
+        }
+
+        if (it == area->lightEmitters.end())
+            it = area->lightEmitters.emplace(Vector2(position), LightEmitter(Vector2(position), position.z)).first;
+
+        if (it->second.setLightSources(lightSources) || it->second.isDirty)
+            markDirty(*area, it->second);
+    }
+
+    for (auto position : sightBlockingChanges)
+    {
+        auto maxRadius = Vector2(LightSource::maxRadius, LightSource::maxRadius);
+        Rect affectingRegion(Vector2(position) - maxRadius, maxRadius * 2 + Vector2(1, 1));
+
+        for (auto* area : getExistingAreas(affectingRegion, position.z))
+        {
+            for (auto& positionAndEmitter : area->lightEmitters)
+            {
+                if (positionAndEmitter.second.isWithinRadius(Vector2(position)))
+                    markDirty(*area, positionAndEmitter.second);
+            }
+        }
+    }
+
+    lightSourceChanges.clear();
+    sightBlockingChanges.clear();
+
+    for (auto* area : areasWithDirtyEmitters)
+    {
+        for (auto& positionAndEmitter : area->lightEmitters)
+        {
+            auto& emitter = positionAndEmitter.second;
+
+            if (!emitter.isDirty)
+                continue;
+
+            regionsToRelight.emplace_back(emitter.getRegion(), area->level);
+            emitter.update(*this);
+            regionsToRelight.emplace_back(emitter.getRegion(), area->level);
+        }
+    }
+
+    for (auto& [region, level] : regionsToRelight)
+        relight(region, level);
+
+    regionsToRelight.clear();
+}
+
+std::vector<Vector2> World::takeChangedTiles(Rect region, int level)
+{
+    std::vector<Vector2> changedTiles;
+
+    for (auto* area : getExistingAreas(region, level))
+    {
+        auto areaRegion = area->getRegion();
+        int left = std::max(region.getLeft(), areaRegion.getLeft());
+        int right = std::min(region.getRight(), areaRegion.getRight());
+        int top = std::max(region.getTop(), areaRegion.getTop());
+        int bottom = std::min(region.getBottom(), areaRegion.getBottom());
+        uint64_t columnMask = (~uint64_t(0) >> (63 - (right - left))) << (left - areaRegion.getLeft());
+
+        for (int y = top; y <= bottom; ++y)
+        {
+            for (uint64_t row = area->layers->changedTiles[size_t(y - areaRegion.getTop())] & columnMask; row; row &= row - 1)
+                changedTiles.push_back(Vector2(areaRegion.getLeft() + countTrailingZeros(row), y));
+        }
+
+        // Changes outside the region don't need to be redrawn, as the whole region is redrawn when it moves.
+        std::fill(area->layers->changedTiles.begin(), area->layers->changedTiles.end(), 0);
+    }
+
+    return changedTiles;
+}
+
+void World::relight(Rect region, int level)
+{
+    auto ambientLight = level >= 0 ? sunlight : Color::black;
+    auto regionAreas = getExistingAreas(region, level);
+
+    for (auto* area : regionAreas)
+    {
+        auto areaRegion = area->getRegion();
+        int left = std::max(region.getLeft(), areaRegion.getLeft());
+        int right = std::min(region.getRight(), areaRegion.getRight());
+        int top = std::max(region.getTop(), areaRegion.getTop());
+        int bottom = std::min(region.getBottom(), areaRegion.getBottom());
+
+        uint64_t columnMask = (~uint64_t(0) >> (63 - (right - left))) << (left - areaRegion.getLeft());
+
+        for (int y = top; y <= bottom; ++y)
+        {
+            auto row = area->layers->lights.begin() + (y - areaRegion.getTop()) * Area::size;
+            std::fill(row + left - areaRegion.getLeft(), row + right + 1 - areaRegion.getLeft(), ambientLight);
+            area->layers->changedTiles[size_t(y - areaRegion.getTop())] |= columnMask;
+        }
+
+        onSightChanged(*area);
+    }
+
+    auto maxRadius = Vector2(LightSource::maxRadius, LightSource::maxRadius);
+
+    for (auto* emitterArea : getExistingAreas(region.inset(-maxRadius), level))
+    {
+        for (auto& positionAndEmitter : emitterArea->lightEmitters)
+        {
+            for (auto* area : regionAreas)
+                positionAndEmitter.second.apply(*area, region);
+        }
+    }
+}
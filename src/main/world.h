@@ -1,10 +1,20 @@
 #pragma once
 
 #include "area.h"
+#include "areapager.h"
+#include "sightmap.h"
 #include "engine/color.h"
 #include "engine/geometry.h"
+#include "engine/math.h"
+#include "engine/threadpool.h"
+#include "engine/workqueue.h"
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <future>
 #include <unordered_map>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 class Creature;
@@ -15,29 +25,120 @@ class Tile;
 class World
 {
 public:
-    void load(SaveFile& file);
-    void save(SaveFile& file) const;
+    void load(SaveFile file);
+    /// Stops reading areas from the loaded save file, so that the file can be overwritten.
+    void releaseSaveFile();
+    void save(SaveFile& file);
+    /// Continues reading the areas that haven't been loaded yet from the file last written by save,
+    /// once it has replaced the loaded save file.
+    void switchSaveFile(SaveFile file);
     int getTurn() const;
     void exist(Rect region, int level);
     void render(Window&, Rect region, int level, const Creature& player);
     Tile* getOrCreateTile(Vector2 position, int level);
     Tile* getTile(Vector2 position, int level);
+    /// Returns the tiles in the region that exist. Loads areas like getTile, but never generates them.
     std::vector<Tile*> getTiles(Rect region, int level);
+    /// Returns a snapshot of the tiles in the region for casting rays over. Loads areas like getTile.
+    SightMap getSightMap(Rect region, int level);
     Creature* addCreature(std::unique_ptr<Creature> creature);
     std::unique_ptr<Creature> removeCreature(Creature* creature);
+    /// Returns the creatures located within the given region, without loading or generating any areas.
+    std::vector<Creature*> getCreatures(Rect region, int level) const;
+    void onCreatureEntered(Tile& tile);
+    void onCreatureLeft(Tile& tile);
     Color getSunlight() const { return sunlight; }
+    void invalidateLightSources(Vector2 position, int level);
+    void invalidateSightBlocking(Vector2 position, int level);
+    void updateLight();
+    /// Returns the positions of the tiles in the region whose appearance has changed since the last
+    /// call, and forgets the changes made to the areas overlapping the region.
+    std::vector<Vector2> takeChangedTiles(Rect region, int level);
+    /// Adds the areas that have finished generating in the background to the world. Returns true if
+    /// some areas are still being generated.
+    bool installGeneratedAreas();
+    uint64_t getSightVersion() const { return sightVersion; }
+    uint64_t getSightVersion(Vector3 areaPosition) const;
+    static Vector3 globalPositionToAreaPosition(Vector2 position, int level);
+    static Vector2 globalPositionToTilePosition(Vector2 position);
 
     const Game* game = nullptr;
+    /// Determines the generated contents of every area, regardless of the order they're generated in.
+    RNG::result_type seed = RNG::default_seed;
+    /// If false, the areas are updated one after another on the main thread. The outcome is the same.
+    bool isSimulationParallel = true;
 
 private:
+    /// An area that is generated apart from the world, possibly on a background thread, and added
+    /// to the world once it's needed.
+    struct GeneratedArea
+    {
+        std::unique_ptr<Area> area;
+        std::vector<std::unique_ptr<Creature>> creatures;
+        std::vector<Vector2> stairsDownAbove;
+        std::vector<Vector2> removedStairsDown;
+        /// Set by whichever thread starts generating the area first.
+        std::atomic<bool> isClaimed = false;
+    };
+
     Area* getOrCreateArea(Vector3 position);
     Area* getArea(Vector3 position);
-    static Vector3 globalPositionToAreaPosition(Vector2 position, int level);
-    static Vector2 globalPositionToTilePosition(Vector2 position);
+    Area* getResidentArea(Vector3 position);
+    std::vector<Area*> getExistingAreas(Rect region, int level);
+    void onAreaCreated(Area& area);
+    void relight(Rect region, int level);
+    void onSightChanged(Area& area);
+    void forEachArea(size_t count, const std::function<void(size_t)>& task);
+    /// Prefetches the areas around the given area, and evicts the least recently used areas that are
+    /// further away once there are too many of them in memory.
+    void pageAreas(Vector3 centerAreaPosition);
+    void evictArea(Vector3 position);
+    /// Adds the areas that have finished generating to the world, and starts generating the missing
+    /// ones around the given area in the background, closest first. At most maxPendingAreas areas
+    /// are generated at a time.
+    void generateAreasAhead(Vector3 centerAreaPosition);
+    std::shared_ptr<GeneratedArea> prepareArea(Vector3 position);
+    void generateArea(Vector3 position, GeneratedArea& generatedArea);
+    Area& installArea(Vector3 position, GeneratedArea& generatedArea);
+    bool areaExists(Vector3 position) const;
+    std::vector<char> readSavedArea(std::pair<int64_t, size_t> offsetAndSize) const;
 
     std::unordered_map<Vector3, Area> areas;
-    std::unordered_map<Vector3, int64_t> savedAreaOffsets;
-    std::vector<std::unique_ptr<Creature>> creatures;
+    AreaPager areaPager;
+    /// Offsets and sizes of the areas that are still read directly from the loaded save file.
+    std::unordered_map<Vector3, std::pair<int64_t, size_t>> savedAreas;
     std::unique_ptr<SaveFile> saveFile;
+    /// Offsets and sizes of the same areas in the file written by the last call to save.
+    std::unordered_map<Vector3, std::pair<int64_t, size_t>> savedAreasInNewFile;
+    std::unordered_map<Vector3, std::pair<std::shared_ptr<GeneratedArea>, std::future<void>>> pendingAreas;
+    std::vector<std::unique_ptr<Creature>> creatures;
+    std::vector<Vector3> lightSourceChanges;
+    std::vector<Vector3> sightBlockingChanges;
+    std::vector<std::pair<Rect, int>> regionsToRelight;
     Color sunlight = Color(0x888888FF);
+    std::atomic<uint64_t> sightVersion = 0;
+    ThreadPool threadPool;
+    /// Guards the state above that creatures in different areas may modify simultaneously.
+    std::mutex mutex;
+    /// Set while areas are updated in parallel, during which no areas are loaded or generated.
+    bool areasAreFrozen = false;
+    uint64_t pagingClock = 0;
+    /// Incremented by every call to exist.
+    uint64_t simulationStep = 0;
+    /// Creatures are updated only in the areas this close to the player's area. With the batches
+    /// taking every third area, a distance of 2 puts up to four areas in each batch.
+    static const int simulationDistance = 2;
+    static const int simulationBatchStride = 3;
+    /// One more than simulationDistance, so that the simulated creatures can walk into the areas
+    /// next to theirs.
+    static const int pagingDistance = simulationDistance + 1;
+    static const int maxPendingAreas = 8;
+    static const int maxResidentAreas = 64;
+    static_assert((pagingDistance * 2 + 1) * (pagingDistance * 2 + 1) + 2 <= maxResidentAreas,
+                  "the areas around the player must fit in memory at once");
+    /// The area being generated on the current thread, if any. World changes made by the generator
+    /// aren't tracked one by one, as onAreaCreated picks them up when the area is installed.
+    static thread_local GeneratedArea* areaBeingGenerated;
+    /// Declared last, so that the workers are stopped before the state they use is destroyed.
+    WorkQueue generationQueue { std::max(1u, std::thread::hardware_concurrency() / 2) };
 };
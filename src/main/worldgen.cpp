@@ -1,15 +1,12 @@
 #include "worldgen.h"
+#include "area.h"
 #include "game.h"
 #include "object.h"
 #include "tile.h"
-#include "world.h"
 #include "engine/assert.h"
 #include "engine/config.h"
 #include "engine/geometry.h"
 #include "engine/math.h"
-#include <climits>
-#include <unordered_map>
-#include <unordered_set>
 
 Building::Building(std::vector<Room>&& rooms)
 :   rooms(std::move(rooms))
@@ -28,23 +25,26 @@ std::vector<Tile*> Building::getDoorTiles() const
     return doorTiles;
 }
 
-WorldGenerator::WorldGenerator(World& world)
-:   world(world)
+WorldGenerator::WorldGenerator(Area& area, std::vector<Vector2> stairsDownAbove, RNG areaRNG)
+:   area(area), stairsDownAbove(std::move(stairsDownAbove)), areaRNG(std::move(areaRNG))
 {
 }
 
-void WorldGenerator::generateRegion(Rect region, int level)
+void WorldGenerator::generateArea()
 {
-    auto buildings = generateBuildings(region, level);
+    // The items and creatures draw their random properties from the same stream.
+    ScopedRNG scopedRNG(std::move(areaRNG));
+    Rect region(area.position * Area::sizeVector, Area::sizeVector);
+    auto buildings = generateBuildings(region);
 
-    if (level < 0)
+    if (area.level < 0)
         generatePaths(buildings);
 
-    generateItems(region, level);
-    generateCreatures(region, level);
+    generateItems(region);
+    generateCreatures(region);
 }
 
-std::vector<Building> WorldGenerator::generateBuildings(Rect region, int level)
+std::vector<Building> WorldGenerator::generateBuildings(Rect region)
 {
     auto minSize = 4;
     auto maxSize = 10;
@@ -52,30 +52,24 @@ std::vector<Building> WorldGenerator::generateBuildings(Rect region, int level)
 
     std::vector<Building> buildings;
 
-    if (world.getTile(region.position, level + 1) != nullptr)
+    for (auto stairsPosition : stairsDownAbove)
     {
-        for (auto* tile : world.getTiles(region, level + 1))
-        {
-            if (tile->hasObject() && tile->getObject()->getId() == "StairsDown")
-            {
-                // TODO: Make this building exactly the same size as the one above it, so that the
-                // generation of the building always succeeds, so that we don't have to remove any
-                // StairsDown from the above building, which is nasty.
+        // TODO: Make this building exactly the same size as the one above it, so that the
+        // generation of the building always succeeds, so that we don't have to remove any
+        // StairsDown from the above building, which is nasty.
 
-                auto size = makeRandomVector(minSize, maxSize);
-                // Makes sure the StairsUp are inside the building.
-                auto topLeftPosition = tile->getPosition() - Vector2(1, 1) - makeRandomVector(size - Vector2(3, 3));
-                auto building = generateBuilding(Rect(topLeftPosition, size), level);
+        auto size = makeRandomVector(minSize, maxSize);
+        // Makes sure the StairsUp are inside the building.
+        auto topLeftPosition = stairsPosition - Vector2(1, 1) - makeRandomVector(size - Vector2(3, 3));
+        auto building = generateBuilding(Rect(topLeftPosition, size));
 
-                if (building)
-                {
-                    tile->getTileBelow()->setObject(std::make_unique<Object>("StairsUp"));
-                    buildings.push_back(std::move(*building));
-                }
-                else
-                    tile->setObject(nullptr);
-            }
+        if (building)
+        {
+            getTile(stairsPosition)->setObject(std::make_unique<Object>("StairsUp"));
+            buildings.push_back(std::move(*building));
         }
+        else
+            removedStairsDown.push_back(stairsPosition);
     }
 
     while (buildings.size() < buildingsToGenerate)
@@ -83,23 +77,23 @@ std::vector<Building> WorldGenerator::generateBuildings(Rect region, int level)
         auto size = makeRandomVector(minSize, maxSize);
         auto topLeftPosition = region.position + makeRandomVector(region.size - size);
 
-        if (auto building = generateBuilding(Rect(topLeftPosition, size), level))
+        if (auto building = generateBuilding(Rect(topLeftPosition, size)))
             buildings.push_back(std::move(*building));
     }
 
     if (!buildings.empty())
     {
         auto& randomRoom = randomElement(randomElement(buildings).rooms);
-        Tile* stairsTile = world.getTile(makeRandomVectorInside(randomRoom.getInnerRegion()), level);
+        Tile* stairsTile = getTile(makeRandomVectorInside(randomRoom.getInnerRegion()));
         stairsTile->setObject(std::make_unique<Object>("StairsDown"));
     }
 
     return buildings;
 }
 
-std::optional<Building> WorldGenerator::generateBuilding(Rect region, int level)
+std::optional<Building> WorldGenerator::generateBuilding(Rect region)
 {
-    if (auto room = generateRoom(region, level))
+    if (auto room = generateRoom(region))
     {
         std::vector<Room> rooms;
         rooms.push_back(std::move(*room));
@@ -109,11 +103,17 @@ std::optional<Building> WorldGenerator::generateBuilding(Rect region, int level)
         return std::nullopt;
 }
 
-std::optional<Room> WorldGenerator::generateRoom(Rect region, int level)
+std::optional<Room> WorldGenerator::generateRoom(Rect region)
 {
+    auto tiles = getTiles(region);
+
+    // Rooms must fit inside the area.
+    if (tiles.size() != size_t(region.getArea()))
+        return std::nullopt;
+
     bool canGenerateHere = true;
 
-    for (auto* tile : world.getTiles(region, level))
+    for (auto* tile : tiles)
     {
         if (tile->getGroundId() == "WoodenFloor" && !tile->hasObject())
             canGenerateHere = false;
@@ -126,7 +126,7 @@ std::optional<Room> WorldGenerator::generateRoom(Rect region, int level)
     auto floorId = "WoodenFloor";
     auto doorId = "Door";
 
-    for (auto* tile : world.getTiles(region, level))
+    for (auto* tile : tiles)
     {
         tile->setGround(floorId);
         tile->setObject(nullptr);
@@ -144,7 +144,7 @@ std::optional<Room> WorldGenerator::generateRoom(Rect region, int level)
 
     auto generateWall = [&](Vector2 position)
     {
-        if (auto* tile = world.getOrCreateTile(position, level))
+        if (auto* tile = getTile(position))
         {
             tile->setObject(std::make_unique<Object>(wallId));
 
@@ -176,7 +176,7 @@ Tile* WorldGenerator::findPathStart(Tile& tile) const
 {
     for (auto direction : { North, East, South, West })
     {
-        auto* adjacentTile = tile.getAdjacentTile(direction);
+        auto* adjacentTile = getTile(tile.getPosition() + direction);
 
         if (adjacentTile && adjacentTile->getGroundId() != "WoodenFloor")
             return adjacentTile;
@@ -185,91 +185,13 @@ Tile* WorldGenerator::findPathStart(Tile& tile) const
     return nullptr;
 }
 
-static int heuristicCostEstimate(const Tile& a, const Tile& b)
-{
-    Vector2 distance = abs(a.getPosition() - b.getPosition());
-    return distance.x * distance.y;
-}
-
-static std::vector<Tile*> reconstructPath(const std::unordered_map<Tile*, Tile*>& cameFrom, Tile* current)
-{
-    std::vector<Tile*> totalPath = { current };
-
-    while (cameFrom.find(current) != cameFrom.end())
-    {
-        current = cameFrom.at(current);
-        totalPath.push_back(current);
-    }
-
-    return totalPath;
-}
-
-std::vector<Tile*> WorldGenerator::findPathAStar(Tile& source, Tile& target, const std::function<bool(Tile&)>& isAllowed) const
-{
-    std::unordered_set<Tile*> closedSet;
-    std::unordered_set<Tile*> openSet;
-    openSet.emplace(&source);
-    std::unordered_map<Tile*, Tile*> sources;
-    std::unordered_map<Tile*, int> costs;
-    costs.emplace(&source, 0);
-    std::unordered_map<Tile*, int> estimatedCosts;
-    estimatedCosts.emplace(&source, heuristicCostEstimate(source, target));
-
-    auto comparator = [&](Tile* a, Tile* b) { return estimatedCosts.at(a) < estimatedCosts.at(b); };
-
-    while (!openSet.empty())
-    {
-        auto iteratorToCurrent = std::min_element(openSet.begin(), openSet.end(), comparator);
-        auto current = *iteratorToCurrent;
-
-        if (current == &target)
-            return reconstructPath(sources, current);
-
-        openSet.erase(iteratorToCurrent);
-        closedSet.insert(current);
-
-        for (auto direction : { North, East, South, West })
-        {
-            Tile* neighbor = current->getPreExistingAdjacentTile(direction);
-
-            if (!neighbor || !isAllowed(*neighbor))
-                continue;
-
-            if (closedSet.find(neighbor) != closedSet.end())
-                continue;
-
-            auto it = costs.find(current);
-            auto tentativeCost = (it == costs.end() ? INT_MAX - 1 : it->second) + 1;
-
-            if (openSet.find(neighbor) == openSet.end())
-                openSet.insert(neighbor);
-            else
-            {
-                auto it = costs.find(neighbor);
-                auto neighborCost = it == costs.end() ? INT_MAX - 1 : it->second;
-
-                if (tentativeCost >= neighborCost)
-                    continue;
-            }
-
-            sources.emplace(neighbor, current);
-            costs.emplace(neighbor, tentativeCost);
-
-            auto neighborIt = costs.find(neighbor);
-            auto neighborCost = neighborIt == costs.end() ? INT_MAX - 1 : neighborIt->second;
-            estimatedCosts.emplace(neighbor, neighborCost + heuristicCostEstimate(*neighbor, target));
-        }
-    }
-
-    return {};
-}
-
 void WorldGenerator::generatePaths(const std::vector<Building>& buildings)
 {
     if (buildings.empty())
         return;
 
     auto& buildingA = randomElement(buildings);
+    std::function<Tile*(Vector2)> getAreaTile = [&](Vector2 position) { return getTile(position); };
 
     for (auto& buildingB : buildings)
     {
@@ -290,19 +212,19 @@ void WorldGenerator::generatePaths(const std::vector<Building>& buildings)
                 if (!pathEnd)
                     continue;
 
-                auto path = findPathAStar(*pathStart, *pathEnd, [](Tile& tile)
+                auto path = pathFinder.findPath(*pathStart, *pathEnd, [](Tile& tile)
                 {
                     return !tile.hasObject() || tile.getObject()->getId() == "Door"
                         || startsWith(tile.getObject()->getId(), "Stairs");
-                });
+                }, false, getAreaTile);
 
                 if (!path.empty())
                     continue;
 
-                path = findPathAStar(*pathStart, *pathEnd, [](Tile& tile)
+                path = pathFinder.findPath(*pathStart, *pathEnd, [](Tile& tile)
                 {
                     return !tile.hasObject() || tile.getObject()->getId() != "BrickWall";
-                });
+                }, false, getAreaTile);
 
                 for (auto* pathTile : path)
                     pathTile->setObject(nullptr);
@@ -311,7 +233,7 @@ void WorldGenerator::generatePaths(const std::vector<Building>& buildings)
     }
 }
 
-void WorldGenerator::generateItems(Rect region, int level)
+void WorldGenerator::generateItems(Rect region)
 {
     auto density = 0.75;
 
@@ -331,13 +253,13 @@ void WorldGenerator::generateItems(Rect region, int level)
         Tile* tile = nullptr;
 
         while (!tile || tile->hasObject())
-            tile = world.getTile(makeRandomVectorInside(region), level);
+            tile = getTile(makeRandomVectorInside(region));
 
         tile->addItem(std::move(item));
     }
 }
 
-void WorldGenerator::generateCreatures(Rect region, int level)
+void WorldGenerator::generateCreatures(Rect region)
 {
     auto density = 0.75;
 
@@ -346,8 +268,35 @@ void WorldGenerator::generateCreatures(Rect region, int level)
         Tile* tile = nullptr;
 
         while (!tile || tile->hasObject())
-            tile = world.getTile(makeRandomVectorInside(region), level);
+            tile = getTile(makeRandomVectorInside(region));
 
         tile->spawnCreature("Bat");
     }
 }
+
+Tile* WorldGenerator::getTile(Vector2 position) const
+{
+    auto areaPosition = position - area.position * Area::sizeVector;
+
+    if (areaPosition.x < 0 || areaPosition.x >= Area::size || areaPosition.y < 0 || areaPosition.y >= Area::size)
+        return nullptr;
+
+    return &area.getTileAt(areaPosition);
+}
+
+std::vector<Tile*> WorldGenerator::getTiles(Rect region) const
+{
+    std::vector<Tile*> tiles;
+    tiles.reserve(region.getArea());
+
+    for (int y = region.getTop(); y <= region.getBottom(); ++y)
+    {
+        for (int x = region.getLeft(); x <= region.getRight(); ++x)
+        {
+            if (auto* tile = getTile(Vector2(x, y)))
+                tiles.push_back(tile);
+        }
+    }
+
+    return tiles;
+}
@@ -1,12 +1,13 @@
 #pragma once
 
+#include "pathfinding.h"
 #include "engine/geometry.h"
-#include <functional>
+#include "engine/math.h"
 #include <optional>
 #include <vector>
 
+class Area;
 class Tile;
-class World;
 struct Rect;
 
 class Room
@@ -29,19 +30,29 @@ public:
     std::vector<Room> rooms;
 };
 
+/// Generates the contents of a single area. Only the tiles of the area are accessed, so that areas
+/// can be generated on any thread before they're added to the world. All random numbers are drawn
+/// from `areaRNG`, so the same generator state always produces the same area.
 class WorldGenerator
 {
 public:
-    WorldGenerator(World& world);
-    void generateRegion(Rect region, int level);
-    std::vector<Building> generateBuildings(Rect region, int level);
-    std::optional<Building> generateBuilding(Rect region, int level);
-    std::optional<Room> generateRoom(Rect region, int level);
+    /// `stairsDownAbove` are the positions of the StairsDown objects in the area above.
+    WorldGenerator(Area& area, std::vector<Vector2> stairsDownAbove, RNG areaRNG);
+    void generateArea();
+    std::vector<Building> generateBuildings(Rect region);
+    std::optional<Building> generateBuilding(Rect region);
+    std::optional<Room> generateRoom(Rect region);
     Tile* findPathStart(Tile& tile) const;
-    std::vector<Tile*> findPathAStar(Tile& source, Tile& target, const std::function<bool(Tile&)>& isAllowed) const;
     void generatePaths(const std::vector<Building>& buildings);
-    void generateItems(Rect region, int level);
-    void generateCreatures(Rect region, int level);
-
-    World& world;
+    void generateItems(Rect region);
+    void generateCreatures(Rect region);
+    Tile* getTile(Vector2 position) const;
+    std::vector<Tile*> getTiles(Rect region) const;
+
+    Area& area;
+    std::vector<Vector2> stairsDownAbove;
+    /// StairsDown in the area above that couldn't be connected to this area, and must be removed.
+    std::vector<Vector2> removedStairsDown;
+    PathFinder pathFinder;
+    RNG areaRNG;
 };